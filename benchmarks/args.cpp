@@ -0,0 +1,300 @@
+#include "bench.h"
+#include "generators.h"
+
+#include <tools/arg_manager.h>
+#include <tools/arg_schema.h>
+
+#include <stdexcept>
+#include <algorithm>
+#include <string_view>
+
+namespace {
+
+//!Command line kept alive for the argv pointers.
+struct command_line {
+
+	explicit command_line(std::vector<std::string> _strings)
+		:strings(std::move(_strings)) {
+
+		point();
+	}
+
+	//!Points argv at the strings again, after adding some.
+	void						point() {
+
+		pointers.clear();
+		for(auto& s : strings) {
+			pointers.push_back(&s[0]);
+		}
+	}
+
+	int							argc() const {return static_cast<int>(pointers.size());}
+	char **						argv() {return pointers.data();}
+
+	std::vector<std::string>	strings;
+	std::vector<char *>			pointers;
+};
+
+//!A mix of flags, valued options and positionals, as the schema expects.
+command_line schema_line() {
+
+	std::vector<std::string> strings={"program", "--verbose", "--threads=8", "--ratio", "0.75", "--name=bench"};
+	for(std::size_t i=0; i<20; i++) {
+		strings.push_back("--include="+bench::random_word(4, 12));
+		strings.push_back(bench::random_word(4, 12)+".txt");
+	}
+
+	return command_line{std::move(strings)};
+}
+
+const std::size_t	option_count=10,	//!< Options of each form in the large line.
+					path_count=4000;	//!< File paths in the large line.
+
+//!A tool run over thousands of files: options of every form spread among
+//!the paths, --flag_N, --set_N=value, --out_N value and key_N=value.
+command_line large_line() {
+
+	std::vector<std::string> strings={"program"};
+	const std::size_t every=path_count/(option_count*4);
+	for(std::size_t i=0; i<path_count; i++) {
+
+		if(0==i%every) {
+
+			const auto n=std::to_string(i/every/4);
+			switch(i/every%4) {
+				case 0: strings.push_back("--flag_"+n); break;
+				case 1: strings.push_back("--set_"+n+"="+bench::random_word(2, 8)); break;
+				case 2: strings.push_back("--out_"+n); strings.push_back(bench::random_word(4, 12)+".out"); break;
+				case 3: strings.push_back("key_"+n+"="+bench::random_word(2, 8)); break;
+			}
+		}
+
+		strings.push_back("data/"+bench::random_word(3, 8)+"/"+bench::random_word(4, 12)+".txt");
+	}
+
+	return command_line{std::move(strings)};
+}
+
+//!The questions asked of the large line: every option and a few missing
+//!ones, which are the worst case of a scan.
+struct queries {
+
+	queries() {
+
+		for(std::size_t i=0; i<option_count; i++) {
+			const auto n=std::to_string(i);
+			flags.push_back("--flag_"+n);
+			options.push_back("set_"+n);
+			options.push_back("out_"+n);
+			keys.push_back("key_"+n);
+		}
+
+		for(std::size_t i=0; i<4; i++) {
+			const auto n=std::to_string(option_count+i);
+			missing_flags.push_back("--flag_"+n);
+			missing_keys.push_back("key_"+n);
+		}
+	}
+
+	std::size_t					size() const {return flags.size()+options.size()+keys.size()+missing_flags.size()+missing_keys.size();}
+
+	std::vector<std::string>	flags,
+								options,
+								keys,
+								missing_flags,
+								missing_keys;
+};
+
+//!value_exists_for as it was before the index: true if any argument begins
+//!with the value.
+bool value_exists_scan(const std::vector<std::string>& _args, const std::string& _value) {
+
+	for(const auto& arg : _args) {
+		if(arg.substr(0, _value.size())==_value) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//!The lookups as arg_manager did them before the index, scanning the
+//!arguments for each question.
+struct scanned_args {
+
+	explicit scanned_args(const std::vector<std::string>& _data)
+		:data(_data) {}
+
+	bool				exists(const std::string& _arg) const {
+
+		return std::end(data)!=std::find(std::begin(data), std::end(data), _arg);
+	}
+
+	bool				value_exists_for(const std::string& _value) const {
+
+		return value_exists_scan(data, _value);
+	}
+
+	std::string_view	get_value_view(const std::string& _key) const {
+
+		const auto prefix=_key+"=";
+		for(const std::string_view arg : data) {
+			if(0==arg.compare(0, prefix.size(), prefix)) {
+				return arg.substr(prefix.size());
+			}
+		}
+
+		return {};
+	}
+
+	std::string_view	get_option(const std::string& _name) const {
+
+		const auto flag="--"+_name;
+		for(std::size_t i=0; i<data.size(); i++) {
+
+			const std::string_view arg=data[i];
+			if(arg==flag) {
+				return i+1 < data.size() ? std::string_view{data[i+1]} : std::string_view{};
+			}
+
+			if(arg.size() > flag.size() && 0==arg.compare(0, flag.size(), flag) && '='==arg[flag.size()]) {
+				return arg.substr(flag.size()+1);
+			}
+		}
+
+		return {};
+	}
+
+	const std::vector<std::string>&	data;
+};
+
+//!Asks every question of the arguments, either arg_manager or the scan.
+template<typename A>
+void ask(const A& _args, const queries& _queries) {
+
+	for(const auto& flag : _queries.flags) {
+		bench::do_not_optimize(_args.exists(flag));
+	}
+
+	for(const auto& option : _queries.options) {
+		bench::do_not_optimize(_args.get_option(option));
+	}
+
+	for(const auto& key : _queries.keys) {
+		bench::do_not_optimize(_args.get_value_view(key));
+	}
+
+	for(const auto& flag : _queries.missing_flags) {
+		bench::do_not_optimize(_args.exists(flag));
+	}
+
+	for(const auto& key : _queries.missing_keys) {
+		bench::do_not_optimize(_args.value_exists_for(key));
+	}
+}
+
+tools::arg_schema make_schema() {
+
+	using types=tools::arg_schema::types;
+
+	tools::arg_schema schema;
+	schema.add({"verbose", types::flag})
+		.add({"threads", types::integer, "1"})
+		.add({"ratio", types::real, "0.5"})
+		.add({"name", types::text, {}, true})
+		.add({"include", types::text, {}, false, true});
+
+	return schema;
+}
+
+}
+
+TOOLS_BENCHMARK(args, arg_manager_build) {
+
+	auto line=large_line();
+
+	ctx.set_items(line.strings.size());
+	ctx.run([&]() {
+		tools::arg_manager args{line.argc(), line.argv()};
+		bench::do_not_optimize(args);
+	});
+}
+
+TOOLS_BENCHMARK(args, arg_manager_lookup) {
+
+	auto line=large_line();
+	const tools::arg_manager args{line.argc(), line.argv()};
+	const queries questions;
+
+	const scanned_args scan{line.strings};
+	for(const auto& option : questions.options) {
+		if(args.get_option(option)!=scan.get_option(option)) {
+			throw std::runtime_error("get_option disagrees with the scan for "+option);
+		}
+	}
+
+	for(const auto& key : questions.keys) {
+		if(args.get_value_view(key)!=scan.get_value_view(key)) {
+			throw std::runtime_error("get_value_view disagrees with the scan for "+key);
+		}
+	}
+
+	ctx.set_items(questions.size());
+	ctx.run([&]() {
+		ask(args, questions);
+	});
+}
+
+//!The same questions answered by scanning, as before the index.
+TOOLS_BENCHMARK(args, arg_manager_lookup_scan) {
+
+	auto line=large_line();
+	const scanned_args args{line.strings};
+	const queries questions;
+
+	ctx.set_items(questions.size());
+	ctx.run([&]() {
+		ask(args, questions);
+	});
+}
+
+TOOLS_BENCHMARK(args, arg_schema_parse) {
+
+	auto line=schema_line();
+	const auto schema=make_schema();
+
+	ctx.set_items(line.strings.size());
+	ctx.run([&]() {
+		const auto values=schema.parse(line.argc(), line.argv());
+		bench::do_not_optimize(values.get<int>("threads"));
+		bench::do_not_optimize(values.get<double>("ratio"));
+		bench::do_not_optimize(values.get_all<std::string_view>("include").size());
+	});
+}
+
+//!Keys preceded by arguments that begin with them, as in "keyboard key=1",
+//!which value_exists_for must answer as the scan did. Checked before being
+//!measured.
+TOOLS_BENCHMARK(args, arg_manager_prefixed_keys) {
+
+	command_line line{{"key", "keyboard", "key=1", "keys=2", "program", "other=3"}};
+	for(std::size_t i=0; i<20; i++) {
+		line.strings.push_back(bench::random_word(4, 12)+".txt");
+	}
+	line.point();
+
+	const tools::arg_manager args{line.argc(), line.argv()};
+	const std::vector<std::string> keys={"key", "keyb", "keyboard", "keys", "oth", "other", "prog", "missing", "key=1"};
+	for(const auto& key : keys) {
+		if(args.value_exists_for(key)!=value_exists_scan(line.strings, key)) {
+			throw std::runtime_error("value_exists_for disagrees with the scan for "+key);
+		}
+	}
+
+	ctx.set_items(keys.size());
+	ctx.run([&]() {
+		for(const auto& key : keys) {
+			bench::do_not_optimize(args.value_exists_for(key));
+		}
+	});
+}
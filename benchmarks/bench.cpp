@@ -0,0 +1,308 @@
+#include "bench.h"
+#include "generators.h"
+
+#include <tools/instrumentation.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <ostream>
+
+#ifndef WITH_INSTRUMENTATION
+
+namespace {
+
+std::atomic<std::uint64_t>	allocation_count{0},
+							allocation_bytes{0};
+
+void * counted_alloc(std::size_t _size) {
+
+	allocation_count.fetch_add(1, std::memory_order_relaxed);
+	allocation_bytes.fetch_add(_size, std::memory_order_relaxed);
+	return std::malloc(_size ? _size : 1);
+}
+
+void * counted_aligned_alloc(std::size_t _size, std::align_val_t _align) {
+
+	allocation_count.fetch_add(1, std::memory_order_relaxed);
+	allocation_bytes.fetch_add(_size, std::memory_order_relaxed);
+
+	//aligned_alloc wants the size to be a multiple of the alignment.
+	const auto align=static_cast<std::size_t>(_align);
+	return std::aligned_alloc(align, ((_size+align-1)/align)*align);
+}
+
+void * throwing(void * _ptr) {
+
+	if(nullptr==_ptr) {
+		throw std::bad_alloc{};
+	}
+
+	return _ptr;
+}
+
+}
+
+//The whole program, the library included, allocates through these.
+void * operator new(std::size_t _size) {return throwing(counted_alloc(_size));}
+void * operator new[](std::size_t _size) {return throwing(counted_alloc(_size));}
+void * operator new(std::size_t _size, const std::nothrow_t&) noexcept {return counted_alloc(_size);}
+void * operator new[](std::size_t _size, const std::nothrow_t&) noexcept {return counted_alloc(_size);}
+void * operator new(std::size_t _size, std::align_val_t _align) {return throwing(counted_aligned_alloc(_size, _align));}
+void * operator new[](std::size_t _size, std::align_val_t _align) {return throwing(counted_aligned_alloc(_size, _align));}
+void operator delete(void * _ptr) noexcept {std::free(_ptr);}
+void operator delete[](void * _ptr) noexcept {std::free(_ptr);}
+void operator delete(void * _ptr, std::size_t) noexcept {std::free(_ptr);}
+void operator delete[](void * _ptr, std::size_t) noexcept {std::free(_ptr);}
+void operator delete(void * _ptr, std::align_val_t) noexcept {std::free(_ptr);}
+void operator delete[](void * _ptr, std::align_val_t) noexcept {std::free(_ptr);}
+void operator delete(void * _ptr, std::size_t, std::align_val_t) noexcept {std::free(_ptr);}
+void operator delete[](void * _ptr, std::size_t, std::align_val_t) noexcept {std::free(_ptr);}
+
+#endif
+
+using namespace bench;
+
+allocation_counters bench::allocations() {
+
+#ifdef WITH_INSTRUMENTATION
+	//The library already replaces operator new, counting per thread.
+	const auto counted=tools::instrumentation::thread_allocations();
+	return {counted.count, counted.bytes};
+#else
+	return {allocation_count.load(std::memory_order_relaxed), allocation_bytes.load(std::memory_order_relaxed)};
+#endif
+}
+
+std::vector<entry>& bench::registry() {
+
+	static std::vector<entry> entries;
+	return entries;
+}
+
+registrar::registrar(const char * _suite, const char * _name, void (*_function)(context&)) {
+
+	registry().push_back({_suite, _name, _function});
+}
+
+context::context(const settings& _config, result& _data)
+	:config(_config), data(_data) {
+
+}
+
+void context::measure(const std::function<void(std::uint64_t)>& _batch) {
+
+	if(done) {
+		return;
+	}
+
+	done=true;
+
+	using clock=std::chrono::steady_clock;
+	auto time=[&_batch](std::uint64_t _iterations) {
+		const auto begin=clock::now();
+		_batch(_iterations);
+		return std::chrono::duration<double, std::nano>(clock::now()-begin).count();
+	};
+
+	//Grows the batch until it takes the minimum time.
+	const double target=std::chrono::duration<double, std::nano>(config.min_time).count();
+	std::uint64_t iterations=1;
+	while(true) {
+
+		const double elapsed=time(iterations);
+		if(elapsed >= target || iterations >= (std::uint64_t{1} << 40)) {
+			break;
+		}
+
+		const double factor=elapsed > 0. ? 1.2*target/elapsed : 10.;
+		iterations=std::max(iterations+1, static_cast<std::uint64_t>(static_cast<double>(iterations)*std::min(factor, 10.)));
+	}
+
+	for(std::size_t i=0; i<config.warmup; i++) {
+		time(iterations);
+	}
+
+	data.iterations=iterations;
+	data.samples.clear();
+	data.samples.reserve(config.repetitions);
+
+	const auto before=allocations();
+	for(std::size_t i=0; i<config.repetitions; i++) {
+		data.samples.push_back(time(iterations)/static_cast<double>(iterations));
+	}
+	const auto after=allocations();
+
+	const double runs=static_cast<double>(iterations*config.repetitions);
+	data.allocations=static_cast<double>(after.count-before.count)/runs;
+	data.allocated_bytes=static_cast<double>(after.bytes-before.bytes)/runs;
+
+	auto sorted=data.samples;
+	std::sort(std::begin(sorted), std::end(sorted));
+
+	const auto n=sorted.size();
+	data.min=sorted.front();
+	data.max=sorted.back();
+	data.median=n % 2 ? sorted[n/2] : (sorted[n/2-1]+sorted[n/2])/2.;
+
+	double sum=0.;
+	for(const auto s : sorted) {
+		sum+=s;
+	}
+	data.mean=sum/static_cast<double>(n);
+
+	double squares=0.;
+	for(const auto s : sorted) {
+		squares+=(s-data.mean)*(s-data.mean);
+	}
+	data.stddev=n > 1 ? std::sqrt(squares/static_cast<double>(n-1)) : 0.;
+}
+
+std::vector<result> bench::run_all(const settings& _config, std::ostream& _out) {
+
+	auto entries=registry();
+	std::sort(std::begin(entries), std::end(entries), [](const entry& _a, const entry& _b) {
+		return std::string{_a.suite}+"/"+_a.name < std::string{_b.suite}+"/"+_b.name;
+	});
+
+	_out<<std::left<<std::setw(48)<<"benchmark"
+		<<std::right<<std::setw(14)<<"median ns"
+		<<std::setw(12)<<"stddev %"
+		<<std::setw(12)<<"allocs"
+		<<std::setw(14)<<"bytes"
+		<<std::setw(16)<<"throughput"<<std::endl;
+
+	std::vector<result> results;
+	for(const auto& e : entries) {
+
+		const std::string full=std::string{e.suite}+"/"+e.name;
+		if(!_config.filter.empty() && std::string::npos==full.find(_config.filter)) {
+			continue;
+		}
+
+		//Every benchmark sees the same data no matter which others run.
+		rng().seed(20240601u);
+
+		result current;
+		current.suite=e.suite;
+		current.name=e.name;
+
+		try {
+			context ctx{_config, current};
+			e.function(ctx);
+
+			if(!current.skipped && current.samples.empty()) {
+				ctx.skip("the benchmark measured nothing");
+			}
+		}
+		catch(std::exception& ex) {
+			current.skipped=true;
+			current.message=ex.what();
+		}
+
+		_out<<std::left<<std::setw(48)<<full<<std::right;
+		if(current.skipped) {
+			_out<<"  skipped: "<<current.message<<std::endl;
+		}
+		else {
+
+			std::string throughput;
+			if(current.bytes) {
+				throughput=std::to_string(static_cast<long long>(static_cast<double>(current.bytes)/current.median*1e3))+" MB/s";
+			}
+			else if(current.items) {
+				throughput=std::to_string(static_cast<long long>(static_cast<double>(current.items)/current.median*1e3))+" M/s";
+			}
+
+			_out<<std::fixed<<std::setprecision(1)
+				<<std::setw(14)<<current.median
+				<<std::setw(12)<<(current.median > 0. ? 100.*current.stddev/current.median : 0.)
+				<<std::setw(12)<<current.allocations
+				<<std::setw(14)<<current.allocated_bytes
+				<<std::setw(16)<<throughput<<std::endl;
+		}
+
+		results.push_back(std::move(current));
+	}
+
+	return results;
+}
+
+namespace {
+
+//!Writes a JSON string with the needed escapes.
+void json_string(std::ostream& _out, const std::string& _value) {
+
+	_out<<'"';
+	for(const char c : _value) {
+
+		switch(c) {
+			case '"':	_out<<"\\\""; break;
+			case '\\':	_out<<"\\\\"; break;
+			case '\n':	_out<<"\\n"; break;
+			case '\t':	_out<<"\\t"; break;
+			default:
+				if(static_cast<unsigned char>(c) < 0x20) {
+					_out<<"\\u00"<<std::hex<<std::setw(2)<<std::setfill('0')<<static_cast<int>(c)<<std::dec<<std::setfill(' ');
+				}
+				else {
+					_out<<c;
+				}
+		}
+	}
+	_out<<'"';
+}
+
+}
+
+void bench::write_json(const std::vector<result>& _results, const settings& _config, std::ostream& _out) {
+
+	_out<<std::setprecision(17)<<"{\"settings\":{\"warmup\":"<<_config.warmup
+		<<",\"repetitions\":"<<_config.repetitions
+		<<",\"min_time_ms\":"<<_config.min_time.count()
+		<<"},\"benchmarks\":[";
+
+	bool first=true;
+	for(const auto& r : _results) {
+
+		if(!first) {
+			_out<<",";
+		}
+		first=false;
+
+		_out<<"{\"suite\":";
+		json_string(_out, r.suite);
+		_out<<",\"name\":";
+		json_string(_out, r.name);
+
+		if(r.skipped) {
+			_out<<",\"skipped\":true,\"message\":";
+			json_string(_out, r.message);
+			_out<<"}";
+			continue;
+		}
+
+		_out<<",\"iterations\":"<<r.iterations
+			<<",\"min_ns\":"<<r.min
+			<<",\"median_ns\":"<<r.median
+			<<",\"mean_ns\":"<<r.mean
+			<<",\"stddev_ns\":"<<r.stddev
+			<<",\"max_ns\":"<<r.max
+			<<",\"allocations\":"<<r.allocations
+			<<",\"allocated_bytes\":"<<r.allocated_bytes
+			<<",\"items\":"<<r.items
+			<<",\"bytes\":"<<r.bytes
+			<<",\"samples_ns\":[";
+
+		for(std::size_t i=0; i<r.samples.size(); i++) {
+			_out<<(i ? "," : "")<<r.samples[i];
+		}
+
+		_out<<"]}";
+	}
+
+	_out<<"]}"<<std::endl;
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+
+//Self contained micro benchmark runner for the library. Benchmarks are
+//functions registered with TOOLS_BENCHMARK(suite, name). They prepare their
+//data and then hand the code to measure to context::run, which finds how
+//many iterations fill a repetition, warms up and measures the repetitions.
+
+//!Declares and registers a benchmark function for the given suite.
+#define TOOLS_BENCHMARK(_suite, _name) \
+	static void bench_##_suite##_##_name(bench::context&); \
+	static const bench::registrar registrar_##_suite##_##_name{#_suite, #_name, &bench_##_suite##_##_name}; \
+	static void bench_##_suite##_##_name(bench::context& ctx)
+
+namespace bench {
+
+//!Keeps the compiler from optimizing away a value.
+template<typename T>
+inline void do_not_optimize(const T& _value) {
+
+#if defined(__GNUC__)
+	__asm__ __volatile__("" : : "r,m"(_value) : "memory");
+#else
+	const volatile char * sink=reinterpret_cast<const volatile char *>(&_value);
+	(void)*sink;
+#endif
+}
+
+//!How benchmarks are run.
+struct settings {
+	std::size_t		warmup=1,				//!< Repetitions run and discarded.
+					repetitions=10;			//!< Repetitions measured.
+	std::chrono::milliseconds	min_time{20};	//!< Minimum time of a repetition.
+	std::string		filter;					//!< Only benchmarks whose "suite/name" contain this are run.
+};
+
+//!Figures of a measured benchmark.
+struct result {
+	std::string		suite,					//!< Suite name.
+					name;					//!< Benchmark name.
+	std::uint64_t	iterations=0;			//!< Iterations per repetition.
+	std::vector<double>	samples;			//!< Nanoseconds per iteration, per repetition.
+	double			min=0.,					//!< Fastest repetition, ns per iteration.
+					median=0.,				//!< Median repetition, ns per iteration.
+					mean=0.,				//!< Mean, ns per iteration.
+					stddev=0.,				//!< Standard deviation, ns per iteration.
+					max=0.,					//!< Slowest repetition, ns per iteration.
+					allocations=0.,			//!< Heap allocations per iteration.
+					allocated_bytes=0.;		//!< Bytes allocated per iteration.
+	std::uint64_t	items=0,				//!< Items processed per iteration, if set.
+					bytes=0;				//!< Bytes processed per iteration, if set.
+	bool			skipped=false;			//!< True if the benchmark could not run.
+	std::string		message;				//!< Why it was skipped.
+};
+
+//!Handed to each benchmark to run the measured code.
+class context {
+
+	public:
+
+	//!Creates a context with the given settings, filling the given result.
+						context(const settings&, result&);
+
+	//!Measures the function. Only the first call in a benchmark counts.
+	template<typename F>
+	void				run(F&& _body) {
+
+		measure([&_body](std::uint64_t _iterations) {
+			for(std::uint64_t i=0; i<_iterations; i++) {
+				_body();
+			}
+		});
+	}
+
+	//!Sets the amount of items each iteration processes, to report
+	//!throughput.
+	void				set_items(std::uint64_t _items) {data.items=_items;}
+
+	//!Sets the amount of bytes each iteration processes, to report
+	//!throughput.
+	void				set_bytes(std::uint64_t _bytes) {data.bytes=_bytes;}
+
+	//!Marks the benchmark as skipped with the reason.
+	void				skip(const std::string& _message) {data.skipped=true; data.message=_message;}
+
+	private:
+
+	//!Calibrates, warms up and measures batches of iterations.
+	void				measure(const std::function<void(std::uint64_t)>&);
+
+	const settings&		config;		//!< How to run.
+	result&				data;		//!< Where to write.
+	bool				done=false;	//!< True once measured.
+};
+
+//!A registered benchmark.
+struct entry {
+	const char *					suite,		//!< Suite name.
+									* name;		//!< Benchmark name.
+	void (*function)(context&);					//!< Benchmark function.
+};
+
+//!Adds a benchmark to the registry when built.
+struct registrar {
+	registrar(const char *, const char *, void (*)(context&));
+};
+
+//!Returns every registered benchmark.
+std::vector<entry>&		registry();
+
+//!Runs every benchmark that passes the filter, reporting each to the
+//!output as it finishes.
+std::vector<result>		run_all(const settings&, std::ostream&);
+
+//!Writes the results as JSON.
+void					write_json(const std::vector<result>&, const settings&, std::ostream&);
+
+//!Heap allocation counters, fed by the replaced operator new.
+struct allocation_counters {
+	std::uint64_t	count,		//!< Allocations.
+					bytes;		//!< Bytes requested.
+};
+
+//!Returns the allocations made by the program so far. When the library is
+//!built with instrumentation, which counts allocations itself, only those
+//!of the calling thread.
+allocation_counters		allocations();
+
+}
@@ -0,0 +1,235 @@
+#include "generators.h"
+
+#include <fstream>
+#include <cstdint>
+#include <stdexcept>
+
+using namespace bench;
+
+std::mt19937& bench::rng() {
+
+	static std::mt19937 engine{20240601u};
+	return engine;
+}
+
+std::string bench::random_word(std::size_t _min, std::size_t _max) {
+
+	std::uniform_int_distribution<std::size_t> length(_min, _max);
+	std::uniform_int_distribution<int> letter('a', 'z');
+
+	std::string result(length(rng()), ' ');
+	for(auto& c : result) {
+		c=static_cast<char>(letter(rng()));
+	}
+
+	return result;
+}
+
+std::string bench::random_text(std::size_t _bytes, char _separator) {
+
+	std::string result;
+	result.reserve(_bytes+16);
+
+	while(result.size() < _bytes) {
+
+		if(!result.empty()) {
+			result+=_separator;
+		}
+
+		result+=random_word(2, 10);
+	}
+
+	return result;
+}
+
+std::string bench::random_lines(std::size_t _lines, std::size_t _words) {
+
+	std::string result;
+	for(std::size_t i=0; i<_lines; i++) {
+
+		if(0==i % 10) {
+			result+="# ";
+		}
+
+		for(std::size_t w=0; w<_words; w++) {
+			result+=(w ? " " : "")+random_word(2, 10);
+		}
+
+		result+='\n';
+	}
+
+	return result;
+}
+
+namespace {
+
+//!Appends the code point encoded as UTF-8.
+void append_utf8(std::string& _out, char32_t _cp) {
+
+	if(_cp < 0x80) {
+		_out+=static_cast<char>(_cp);
+	}
+	else if(_cp < 0x800) {
+		_out+=static_cast<char>(0xC0 | (_cp >> 6));
+		_out+=static_cast<char>(0x80 | (_cp & 0x3F));
+	}
+	else if(_cp < 0x10000) {
+		_out+=static_cast<char>(0xE0 | (_cp >> 12));
+		_out+=static_cast<char>(0x80 | ((_cp >> 6) & 0x3F));
+		_out+=static_cast<char>(0x80 | (_cp & 0x3F));
+	}
+	else {
+		_out+=static_cast<char>(0xF0 | (_cp >> 18));
+		_out+=static_cast<char>(0x80 | ((_cp >> 12) & 0x3F));
+		_out+=static_cast<char>(0x80 | ((_cp >> 6) & 0x3F));
+		_out+=static_cast<char>(0x80 | (_cp & 0x3F));
+	}
+}
+
+//!Appends a random word of the language: 0 is Spanish like Latin with
+//!precomposed accents and combining marks, 1 Cyrillic and 2 Japanese kana
+//!and kanji. One word in twelve is followed by an emoji, some of them
+//!sequences joined by zero width joiners or variation selectors.
+void append_word(std::string& _out, std::size_t _language) {
+
+	const char32_t	accented[]={U'\u00e1', U'\u00e9', U'\u00ed', U'\u00f3', U'\u00fa', U'\u00f1', U'\u00fc', U'\u00e7'},
+					vowels[]={U'a', U'e', U'i', U'o', U'u'},
+					marks[]={U'\u0301', U'\u0308', U'\u0303'};
+	const char *	emoji[]={
+		"\xf0\x9f\x98\x80",	//Grinning face.
+		"\xf0\x9f\x91\x8d\xf0\x9f\x8f\xbd",	//Thumbs up, medium skin tone.
+		"\xe2\x9d\xa4\xef\xb8\x8f",	//Heart, emoji presentation.
+		"\xf0\x9f\x91\xa8\xe2\x80\x8d\xf0\x9f\x91\xa9\xe2\x80\x8d\xf0\x9f\x91\xa7"	//Family, joined.
+	};
+
+	std::uniform_int_distribution<int> length(2, 9), percent(0, 99);
+	std::uniform_int_distribution<std::size_t> pick(0, 7);
+	std::uniform_int_distribution<std::uint32_t> latin('a', 'z'), cyrillic(0x0430, 0x044F), kana(0x3041, 0x3093), kanji(0x4E00, 0x9FA5);
+
+	for(int letters=length(rng()); letters; letters--) {
+
+		const auto roll=percent(rng());
+		switch(_language) {
+			case 0:
+				if(roll < 10) {
+					append_utf8(_out, accented[pick(rng())]);
+				}
+				else if(roll < 14) {
+					append_utf8(_out, vowels[pick(rng()) % 5]);
+					append_utf8(_out, marks[pick(rng()) % 3]);
+				}
+				else {
+					append_utf8(_out, latin(rng()));
+				}
+			break;
+			case 1:
+				append_utf8(_out, roll < 5 ? latin(rng()) : cyrillic(rng()));
+			break;
+			default:
+				append_utf8(_out, roll < 70 ? kana(rng()) : kanji(rng()));
+			break;
+		}
+	}
+
+	if(percent(rng()) < 8) {
+		_out+=emoji[pick(rng()) % 4];
+	}
+}
+
+//!Writes catalog entries whose values come from the given function.
+template<typename F>
+std::string make_catalog(std::size_t _first, std::size_t _entries, F _value) {
+
+	std::string result;
+	for(std::size_t index=_first; index<_first+_entries; index++) {
+
+		result+="[[label-"+std::to_string(index)+"]]{{";
+		_value(result, index);
+		result+=" ((var)) ";
+		if(index % 2) {
+			result+="<<label-"+std::to_string(index-1)+">>";
+		}
+		result+="}}\n";
+	}
+
+	return result;
+}
+
+}
+
+std::string bench::random_catalog(std::size_t _first, std::size_t _entries) {
+
+	return make_catalog(_first, _entries, [](std::string& _out, std::size_t) {
+		_out+=random_text(40);
+	});
+}
+
+std::string bench::random_localized_catalog(std::size_t _first, std::size_t _entries) {
+
+	return make_catalog(_first, _entries, [](std::string& _out, std::size_t _index) {
+
+		const auto start=_out.size();
+		while(_out.size()-start < 60) {
+			if(_out.size()!=start) {
+				_out+=' ';
+			}
+			append_word(_out, _index % 3);
+		}
+	});
+}
+
+std::string bench::random_utf8(std::size_t _bytes) {
+
+	//Latin, Latin-1, CJK and emoji code points.
+	const char * samples[]={"a", "e", "z", " ", "\xc3\xa9", "\xc3\xb1", "\xe6\xbc\xa2", "\xe5\xad\x97", "\xf0\x9f\x98\x80"};
+	std::uniform_int_distribution<std::size_t> pick(0, sizeof(samples)/sizeof(samples[0])-1);
+
+	std::string result;
+	result.reserve(_bytes+4);
+	while(result.size() < _bytes) {
+		result+=samples[pick(rng())];
+	}
+
+	return result;
+}
+
+temp_dir::temp_dir() {
+
+	const auto base=tools::filesystem::temp_directory_path();
+	std::uniform_int_distribution<unsigned> suffix;
+
+	//A separate engine, so creating directories does not change the data.
+	std::random_device device;
+	std::mt19937 engine{device()};
+
+	for(int attempt=0; attempt<16; attempt++) {
+
+		const auto candidate=base/("tools-bench-"+std::to_string(suffix(engine)));
+		if(tools::filesystem::create_directory(candidate)) {
+			path=candidate.string();
+			return;
+		}
+	}
+
+	throw std::runtime_error("could not create a temporary directory in "+base.string());
+}
+
+temp_dir::~temp_dir() {
+
+	std::error_code error;
+	tools::filesystem::remove_all(path, error);
+}
+
+std::string temp_dir::write(const std::string& _name, const std::string& _contents) const {
+
+	const auto full=tools::filesystem::path(path)/_name;
+	tools::filesystem::create_directories(full.parent_path());
+
+	std::ofstream file(full.string(), std::ios::binary);
+	file.write(_contents.data(), _contents.size());
+	if(!file) {
+		throw std::runtime_error("could not write "+full.string());
+	}
+
+	return full.string();
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <tools/file_utils.h>
+
+#include <string>
+#include <vector>
+#include <random>
+#include <cstddef>
+
+//Synthetic data for the benchmark suites. Everything is generated from a
+//fixed seed so runs are comparable.
+
+namespace bench {
+
+//!Returns the shared random engine, seeded the same on every run.
+std::mt19937&				rng();
+
+//!Returns a random lowercase word of the given length range.
+std::string					random_word(std::size_t, std::size_t);
+
+//!Returns about the given amount of bytes of random words separated by the
+//!given character.
+std::string					random_text(std::size_t, char=' ');
+
+//!Returns the given amount of lines of random words, ending each with a
+//!newline. One line out of ten is a comment starting with #.
+std::string					random_lines(std::size_t, std::size_t);
+
+//!Returns about the given amount of bytes of UTF-8 text mixing one to four
+//!byte sequences.
+std::string					random_utf8(std::size_t);
+
+//!Returns the given amount of i8n catalog entries, numbered from the given
+//!index, one per line. Every entry has a variable and every odd numbered
+//!one embeds the entry before it.
+std::string					random_catalog(std::size_t, std::size_t);
+
+//!Same as random_catalog, with the values in Spanish, Russian or Japanese
+//!like text: two and three byte letters, combining marks and emoji, some
+//!of them joined sequences. Labels and markup stay ASCII.
+std::string					random_localized_catalog(std::size_t, std::size_t);
+
+//!A directory under the system temporary directory, removed with its
+//!contents on destruction.
+class temp_dir {
+
+	public:
+
+	//!Creates a new, empty directory.
+							temp_dir();
+							~temp_dir();
+							temp_dir(const temp_dir&)=delete;
+	temp_dir&				operator=(const temp_dir&)=delete;
+
+	//!Writes a file with the contents, creating the directories in its
+	//!relative path. Returns the full path.
+	std::string				write(const std::string&, const std::string&) const;
+
+	//!Returns the path of the directory.
+	const std::string&		get_path() const {return path;}
+
+	private:
+
+	std::string				path;	//!< Full path.
+};
+
+}
@@ -0,0 +1,83 @@
+#include "bench.h"
+#include "generators.h"
+
+#include <tools/i8n.h>
+
+#include <memory>
+
+namespace {
+
+const std::size_t entries_per_file=2000,
+					file_count=4;
+
+//!Writes a synthetic catalog under the directory, in "en". Returns the
+//!file names.
+std::vector<std::string> write_catalog(const bench::temp_dir& _dir) {
+
+	std::vector<std::string> files;
+	for(std::size_t f=0; f<file_count; f++) {
+
+		files.push_back("catalog"+std::to_string(f)+".dat");
+		_dir.write("en/"+files.back(), bench::random_catalog(f*entries_per_file, entries_per_file));
+	}
+
+	return files;
+}
+
+//!Labels to look up, spread over the catalog.
+std::vector<std::string> lookup_labels() {
+
+	std::vector<std::string> result;
+	for(std::size_t i=0; i<1000; i++) {
+		result.push_back("label-"+std::to_string((i*7919) % (entries_per_file*file_count)));
+	}
+
+	return result;
+}
+
+}
+
+TOOLS_BENCHMARK(i8n, load) {
+
+	bench::temp_dir dir;
+	const auto files=write_catalog(dir);
+
+	ctx.set_items(entries_per_file*file_count);
+	ctx.run([&]() {
+		tools::i8n localization{dir.get_path(), "en", files};
+		bench::do_not_optimize(localization);
+	});
+}
+
+TOOLS_BENCHMARK(i8n, get) {
+
+	bench::temp_dir dir;
+	tools::i8n localization{dir.get_path(), "en", write_catalog(dir)};
+	localization.set({"var", "value"});
+	const auto labels=lookup_labels();
+
+	ctx.set_items(labels.size());
+	ctx.run([&]() {
+		std::size_t total=0;
+		for(const auto& label : labels) {
+			total+=localization.get(label).size();
+		}
+		bench::do_not_optimize(total);
+	});
+}
+
+TOOLS_BENCHMARK(i8n, get_with_substitutions) {
+
+	bench::temp_dir dir;
+	const tools::i8n localization{dir.get_path(), "en", write_catalog(dir)};
+	const auto labels=lookup_labels();
+
+	ctx.set_items(labels.size());
+	ctx.run([&]() {
+		std::size_t total=0;
+		for(const auto& label : labels) {
+			total+=localization.get(label, {{"var", "value"}}).size();
+		}
+		bench::do_not_optimize(total);
+	});
+}
@@ -0,0 +1,68 @@
+#include "bench.h"
+#include "generators.h"
+
+#include <tools/json_config_file.h>
+
+namespace {
+
+const std::size_t section_count=100;
+
+//!Returns a document with sections of integers, doubles, bools and
+//!strings, nested three levels deep.
+std::string random_document() {
+
+	std::string result="{";
+	for(std::size_t i=0; i<section_count; i++) {
+
+		const auto index=std::to_string(i);
+		result+=std::string{i ? "," : ""}
+			+"\"section"+index+"\":{"
+				+"\"int\":"+index+","
+				+"\"double\":"+index+".5,"
+				+"\"bool\":"+(i % 2 ? "true" : "false")+","
+				+"\"string\":\""+bench::random_text(32)+"\","
+				+"\"nested\":{\"deeper\":{\"value\":"+index+"}}"
+			+"}";
+	}
+
+	return result+"}";
+}
+
+}
+
+TOOLS_BENCHMARK(json_config_file, load) {
+
+	bench::temp_dir dir;
+	const auto contents=random_document();
+	const auto path=dir.write("config.json", contents);
+
+	ctx.set_bytes(contents.size());
+	ctx.run([&]() {
+		tools::json_config_file config{path};
+		bench::do_not_optimize(config);
+	});
+}
+
+TOOLS_BENCHMARK(json_config_file, from_path) {
+
+	bench::temp_dir dir;
+	const tools::json_config_file config{dir.write("config.json", random_document())};
+
+	std::vector<std::string> paths;
+	for(std::size_t i=0; i<section_count; i++) {
+		paths.push_back("section"+std::to_string(i));
+	}
+
+	ctx.set_items(paths.size()*5);
+	ctx.run([&]() {
+		double total=0.;
+		for(const auto& path : paths) {
+			total+=config.int_from_path(path+":int");
+			total+=config.double_from_path(path+":double");
+			total+=config.bool_from_path(path+":bool");
+			total+=static_cast<double>(config.string_from_path(path+":string").size());
+			total+=config.int_from_path(path+":nested:deeper:value");
+		}
+		bench::do_not_optimize(total);
+	});
+}
@@ -0,0 +1,68 @@
+#include "bench.h"
+
+#include <tools/arg_schema.h>
+
+#include <fstream>
+#include <iostream>
+
+int main(int argc, char ** argv) {
+
+	using types=tools::arg_schema::types;
+
+	tools::arg_schema schema;
+	schema.add({"filter", types::text, ""})
+		.add({"warmup", types::integer, "1"})
+		.add({"repetitions", types::integer, "10"})
+		.add({"min-time", types::integer, "20"})
+		.add({"json", types::text})
+		.add({"list", types::flag})
+		.add({"help", types::flag});
+
+	try {
+
+		const auto args=schema.parse(argc, argv);
+
+		if(args.get<bool>("help")) {
+			std::cout<<"usage: "<<argv[0]<<" [--filter=text] [--warmup=n] [--repetitions=n] [--min-time=ms] [--json=path] [--list]"<<std::endl;
+			return 0;
+		}
+
+		if(args.get<bool>("list")) {
+			for(const auto& e : bench::registry()) {
+				std::cout<<e.suite<<"/"<<e.name<<std::endl;
+			}
+			return 0;
+		}
+
+		bench::settings config;
+		config.filter=args.get<std::string>("filter");
+		config.warmup=args.get<std::size_t>("warmup");
+		config.repetitions=args.get<std::size_t>("repetitions");
+		config.min_time=std::chrono::milliseconds{args.get<unsigned>("min-time")};
+
+		if(!config.repetitions) {
+			std::cerr<<"at least one repetition is needed"<<std::endl;
+			return 1;
+		}
+
+		const auto results=bench::run_all(config, std::cout);
+
+		if(args.is_set("json")) {
+
+			const auto path=args.get<std::string>("json");
+			std::ofstream file(path);
+			bench::write_json(results, config, file);
+			if(!file) {
+				std::cerr<<"could not write "<<path<<std::endl;
+				return 1;
+			}
+		}
+	}
+	catch(tools::arg_schema_exception& e) {
+
+		std::cerr<<e.what()<<std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,780 @@
+#include "bench.h"
+#include "generators.h"
+
+#include <tools/matrix_2d.h>
+#include <tools/matrix_2d_unbound.h>
+#include <tools/matrix_2d_io.h>
+#include <tools/worker_pool.h>
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const unsigned int side=256;
+
+}
+
+namespace {
+
+//!Returns the cells a fill ratio, in percent, leaves occupied, scattered
+//!over the matrix.
+std::vector<unsigned int> filled_cells(unsigned int _percent) {
+
+	std::vector<unsigned int> result(side*side);
+	for(unsigned int i=0; i<result.size(); i++) {
+		result[i]=i;
+	}
+
+	std::shuffle(std::begin(result), std::end(result), bench::rng());
+	result.resize(result.size()*_percent/100);
+	return result;
+}
+
+template<typename S>
+tools::matrix_2d<int, S> filled_matrix(const std::vector<unsigned int>& _cells) {
+
+	tools::matrix_2d<int, S> matrix{side, side};
+	for(const auto cell : _cells) {
+		matrix.insert(cell % side, cell / side, static_cast<int>(cell));
+	}
+
+	return matrix;
+}
+
+template<typename S, unsigned int percent>
+void matrix_insert(bench::context& ctx) {
+
+	const auto cells=filled_cells(percent);
+	ctx.set_items(cells.size());
+	ctx.run([&]() {
+		bench::do_not_optimize(filled_matrix<S>(cells));
+	});
+}
+
+//!Probes every cell, as collision code does.
+template<typename S, unsigned int percent>
+void matrix_lookup(bench::context& ctx) {
+
+	const auto matrix=filled_matrix<S>(filled_cells(percent));
+	ctx.set_items(side*side);
+	ctx.run([&]() {
+		long long total=0;
+		for(unsigned int y=0; y<side; y++) {
+			for(unsigned int x=0; x<side; x++) {
+				if(matrix.count(x, y)) {
+					total+=matrix(x, y);
+				}
+			}
+		}
+		bench::do_not_optimize(total);
+	});
+}
+
+template<typename S, unsigned int percent>
+void matrix_apply(bench::context& ctx) {
+
+	const auto matrix=filled_matrix<S>(filled_cells(percent));
+	ctx.set_items(matrix.size());
+	ctx.run([&]() {
+		long long total=0;
+		auto sum=[&total](int _value) {total+=_value;};
+		matrix.apply(sum);
+		bench::do_not_optimize(total);
+	});
+}
+
+//!Grows and shrinks back, so every repetition starts from the same size.
+template<typename S, unsigned int percent>
+void matrix_resize(bench::context& ctx) {
+
+	auto matrix=filled_matrix<S>(filled_cells(percent));
+	ctx.set_items(matrix.size());
+	ctx.run([&]() {
+		matrix.resize(side+16, side);
+		matrix.resize(side, side);
+		bench::do_not_optimize(matrix.size());
+	});
+}
+
+//!A 40 x 25 viewport moving over the matrix, read with check and
+//!operator() on every cell.
+template<typename S, unsigned int percent>
+void matrix_region_loop(bench::context& ctx) {
+
+	const auto matrix=filled_matrix<S>(filled_cells(percent));
+	ctx.set_items(40*25*16);
+	ctx.run([&]() {
+		long long total=0;
+		for(unsigned int i=0; i<16; i++) {
+			for(unsigned int y=i*13; y<i*13+25; y++) {
+				for(unsigned int x=i*9; x<i*9+40; x++) {
+					if(matrix.check(x, y)) {
+						total+=matrix(x, y);
+					}
+				}
+			}
+		}
+		bench::do_not_optimize(total);
+	});
+}
+
+//!The same viewport read through region().
+template<typename S, unsigned int percent>
+void matrix_region_range(bench::context& ctx) {
+
+	const auto matrix=filled_matrix<S>(filled_cells(percent));
+	ctx.set_items(40*25*16);
+	ctx.run([&]() {
+		long long total=0;
+		for(unsigned int i=0; i<16; i++) {
+			for(const auto cell : matrix.region(i*9, i*13, 40, 25)) {
+				total+=cell.value;
+			}
+		}
+		bench::do_not_optimize(total);
+	});
+}
+
+//!Sums the 8 neighbours of every inner cell the old way, catching the
+//!exception thrown by missing cells.
+template<typename S, unsigned int percent>
+void matrix_neighbours_catch(bench::context& ctx) {
+
+	const auto matrix=filled_matrix<S>(filled_cells(percent));
+	const int dx[8]={0, 1, 0, -1, 1, 1, -1, -1},
+				dy[8]={-1, 0, 1, 0, -1, 1, 1, -1};
+
+	ctx.set_items((side-2)*(side-2)/16);
+	ctx.run([&]() {
+		long long total=0;
+		for(unsigned int y=1; y<side-1; y+=4) {
+			for(unsigned int x=1; x<side-1; x+=4) {
+				for(int i=0; i<8; i++) {
+					try {
+						total+=matrix(x+dx[i], y+dy[i]);
+					}
+					catch(tools::matrix_2d_exception&) {}
+				}
+			}
+		}
+		bench::do_not_optimize(total);
+	});
+}
+
+//!The same sums through neighbours8().
+template<typename S, unsigned int percent>
+void matrix_neighbours_range(bench::context& ctx) {
+
+	const auto matrix=filled_matrix<S>(filled_cells(percent));
+	ctx.set_items((side-2)*(side-2)/16);
+	ctx.run([&]() {
+		long long total=0;
+		for(unsigned int y=1; y<side-1; y+=4) {
+			for(unsigned int x=1; x<side-1; x+=4) {
+				for(const auto cell : matrix.neighbours8(x, y)) {
+					total+=cell.value;
+				}
+			}
+		}
+		bench::do_not_optimize(total);
+	});
+}
+
+using sparse=tools::matrix_2d_sparse<int>;
+using dense=tools::matrix_2d_dense<int>;
+using hashed=tools::matrix_2d_hashed<int>;
+
+}
+
+//Each storage at 10, 50 and 100% full.
+#define TOOLS_MATRIX_2D_BENCHMARKS(_storage) \
+	TOOLS_BENCHMARK(matrix_2d, _storage##_insert_10) {matrix_insert<_storage, 10>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d, _storage##_insert_50) {matrix_insert<_storage, 50>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d, _storage##_insert_100) {matrix_insert<_storage, 100>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d, _storage##_lookup_10) {matrix_lookup<_storage, 10>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d, _storage##_lookup_50) {matrix_lookup<_storage, 50>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d, _storage##_lookup_100) {matrix_lookup<_storage, 100>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d, _storage##_apply_10) {matrix_apply<_storage, 10>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d, _storage##_apply_50) {matrix_apply<_storage, 50>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d, _storage##_apply_100) {matrix_apply<_storage, 100>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d, _storage##_resize_10) {matrix_resize<_storage, 10>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d, _storage##_resize_50) {matrix_resize<_storage, 50>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d, _storage##_resize_100) {matrix_resize<_storage, 100>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d, _storage##_region_loop_10) {matrix_region_loop<_storage, 10>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d, _storage##_region_loop_50) {matrix_region_loop<_storage, 50>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d, _storage##_region_range_10) {matrix_region_range<_storage, 10>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d, _storage##_region_range_50) {matrix_region_range<_storage, 50>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d, _storage##_neighbours_catch_50) {matrix_neighbours_catch<_storage, 50>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d, _storage##_neighbours_range_50) {matrix_neighbours_range<_storage, 50>(ctx);}
+
+TOOLS_MATRIX_2D_BENCHMARKS(sparse)
+TOOLS_MATRIX_2D_BENCHMARKS(dense)
+TOOLS_MATRIX_2D_BENCHMARKS(hashed)
+
+namespace {
+
+//!Item with heap buffers, costly to copy and cheap to move.
+struct heavy {
+
+	explicit		heavy(unsigned int _seed)
+		:name("item "+std::to_string(_seed)+", named past the small string buffer"),
+		values(32, static_cast<int>(_seed)) {
+
+	}
+
+	std::string		name;
+	std::vector<int>	values;
+};
+
+const unsigned int heavy_side=64;
+
+//!Half the cells, scattered.
+std::vector<unsigned int> heavy_cells() {
+
+	std::vector<unsigned int> result(heavy_side*heavy_side);
+	for(unsigned int i=0; i<result.size(); i++) {
+		result[i]=i;
+	}
+
+	std::shuffle(std::begin(result), std::end(result), bench::rng());
+	result.resize(result.size()/2);
+	return result;
+}
+
+template<template<typename> class S>
+using heavy_matrix=tools::matrix_2d<heavy, S<heavy>>;
+
+template<template<typename> class S>
+heavy_matrix<S> filled_heavy(const std::vector<unsigned int>& _cells) {
+
+	heavy_matrix<S> matrix{heavy_side, heavy_side};
+	for(const auto cell : _cells) {
+		matrix.emplace(cell % heavy_side, cell / heavy_side, cell);
+	}
+
+	return matrix;
+}
+
+//!Copies prebuilt items in.
+template<template<typename> class S>
+void heavy_insert_copy(bench::context& ctx) {
+
+	const auto cells=heavy_cells();
+	std::vector<heavy> items;
+	for(const auto cell : cells) {
+		items.emplace_back(cell);
+	}
+
+	ctx.set_items(cells.size());
+	ctx.run([&]() {
+		heavy_matrix<S> matrix{heavy_side, heavy_side};
+		for(std::size_t i=0; i<cells.size(); i++) {
+			matrix.insert(cells[i] % heavy_side, cells[i] / heavy_side, items[i]);
+		}
+		bench::do_not_optimize(matrix);
+	});
+}
+
+//!Builds a temporary and moves it in.
+template<template<typename> class S>
+void heavy_insert_temporary(bench::context& ctx) {
+
+	const auto cells=heavy_cells();
+	ctx.set_items(cells.size());
+	ctx.run([&]() {
+		heavy_matrix<S> matrix{heavy_side, heavy_side};
+		for(const auto cell : cells) {
+			matrix.insert(cell % heavy_side, cell / heavy_side, heavy{cell});
+		}
+		bench::do_not_optimize(matrix);
+	});
+}
+
+//!Builds in place.
+template<template<typename> class S>
+void heavy_emplace(bench::context& ctx) {
+
+	const auto cells=heavy_cells();
+	ctx.set_items(cells.size());
+	ctx.run([&]() {
+		heavy_matrix<S> matrix{heavy_side, heavy_side};
+		for(const auto cell : cells) {
+			matrix.emplace(cell % heavy_side, cell / heavy_side, cell);
+		}
+		bench::do_not_optimize(matrix);
+	});
+}
+
+//!Writes an item to every cell, the old way: check, then assign or insert.
+template<template<typename> class S>
+void heavy_upsert_checked(bench::context& ctx) {
+
+	auto matrix=filled_heavy<S>(heavy_cells());
+	const heavy item{7};
+	ctx.set_items(heavy_side*heavy_side);
+	ctx.run([&]() {
+		for(unsigned int y=0; y<heavy_side; y++) {
+			for(unsigned int x=0; x<heavy_side; x++) {
+				if(matrix.check(x, y)) {
+					matrix(x, y)=item;
+				}
+				else {
+					matrix.insert(x, y, item);
+				}
+			}
+		}
+		bench::do_not_optimize(matrix);
+	});
+}
+
+//!The same writes with insert_or_assign.
+template<template<typename> class S>
+void heavy_insert_or_assign(bench::context& ctx) {
+
+	auto matrix=filled_heavy<S>(heavy_cells());
+	const heavy item{7};
+	ctx.set_items(heavy_side*heavy_side);
+	ctx.run([&]() {
+		for(unsigned int y=0; y<heavy_side; y++) {
+			for(unsigned int x=0; x<heavy_side; x++) {
+				matrix.insert_or_assign(x, y, item);
+			}
+		}
+		bench::do_not_optimize(matrix);
+	});
+}
+
+//!Grows and shrinks back, so every repetition starts from the same size.
+template<template<typename> class S>
+void heavy_resize(bench::context& ctx) {
+
+	auto matrix=filled_heavy<S>(heavy_cells());
+	ctx.set_items(matrix.size());
+	ctx.run([&]() {
+		matrix.resize(heavy_side+16, heavy_side);
+		matrix.resize(heavy_side, heavy_side);
+		bench::do_not_optimize(matrix.size());
+	});
+}
+
+}
+
+//Each storage with an item type that is costly to copy.
+#define TOOLS_MATRIX_2D_HEAVY_BENCHMARKS(_storage) \
+	TOOLS_BENCHMARK(matrix_2d, _storage##_heavy_insert_copy) {heavy_insert_copy<tools::matrix_2d_##_storage>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d, _storage##_heavy_insert_temporary) {heavy_insert_temporary<tools::matrix_2d_##_storage>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d, _storage##_heavy_emplace) {heavy_emplace<tools::matrix_2d_##_storage>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d, _storage##_heavy_upsert_checked) {heavy_upsert_checked<tools::matrix_2d_##_storage>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d, _storage##_heavy_insert_or_assign) {heavy_insert_or_assign<tools::matrix_2d_##_storage>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d, _storage##_heavy_resize) {heavy_resize<tools::matrix_2d_##_storage>(ctx);}
+
+TOOLS_MATRIX_2D_HEAVY_BENCHMARKS(sparse)
+TOOLS_MATRIX_2D_HEAVY_BENCHMARKS(dense)
+TOOLS_MATRIX_2D_HEAVY_BENCHMARKS(hashed)
+
+namespace {
+
+using ordered=tools::matrix_2d_unbound_ordered<int>;
+using chunked=tools::matrix_2d_unbound_chunked<int>;
+
+//!Centered on the origin so negative coordinates are exercised.
+const int half=static_cast<int>(side/2);
+
+template<typename S>
+tools::matrix_2d_unbound<int, S> filled_unbound() {
+
+	tools::matrix_2d_unbound<int, S> matrix;
+	for(int y=-half; y<half; y++) {
+		for(int x=-half; x<half; x++) {
+			matrix.insert(x, y, x+y);
+		}
+	}
+
+	return matrix;
+}
+
+template<typename S>
+void unbound_insert(bench::context& ctx) {
+
+	ctx.set_items(side*side);
+	ctx.run([&]() {
+		bench::do_not_optimize(filled_unbound<S>());
+	});
+}
+
+//!Row by row, as a renderer reads the map.
+template<typename S>
+void unbound_lookup(bench::context& ctx) {
+
+	const auto matrix=filled_unbound<S>();
+	ctx.set_items(side*side);
+	ctx.run([&]() {
+		long long total=0;
+		for(int y=-half; y<half; y++) {
+			for(int x=-half; x<half; x++) {
+				total+=matrix(x, y);
+			}
+		}
+		bench::do_not_optimize(total);
+	});
+}
+
+template<typename S>
+void unbound_apply(bench::context& ctx) {
+
+	const auto matrix=filled_unbound<S>();
+	ctx.set_items(side*side);
+	ctx.run([&]() {
+		long long total=0;
+		auto sum=[&total](int _value) {total+=_value;};
+		matrix.apply(sum);
+		bench::do_not_optimize(total);
+	});
+}
+
+//!A 40 x 25 viewport moving over the map.
+template<typename S>
+void unbound_region(bench::context& ctx) {
+
+	const auto matrix=filled_unbound<S>();
+	ctx.set_items(40*25*16);
+	ctx.run([&]() {
+		long long total=0;
+		auto sum=[&total](int, int, int _value) {total+=_value;};
+		for(int i=0; i<16; i++) {
+			matrix.apply_region(-half+i*7, -half+i*5, 40, 25, sum);
+		}
+		bench::do_not_optimize(total);
+	});
+}
+
+//!The same viewport read through region().
+template<typename S>
+void unbound_region_range(bench::context& ctx) {
+
+	const auto matrix=filled_unbound<S>();
+	ctx.set_items(40*25*16);
+	ctx.run([&]() {
+		long long total=0;
+		for(int i=0; i<16; i++) {
+			for(const auto cell : matrix.region(-half+i*7, -half+i*5, 40, 25)) {
+				total+=cell.value;
+			}
+		}
+		bench::do_not_optimize(total);
+	});
+}
+
+}
+
+TOOLS_BENCHMARK(matrix_2d_unbound, ordered_insert) {unbound_insert<ordered>(ctx);}
+TOOLS_BENCHMARK(matrix_2d_unbound, ordered_lookup) {unbound_lookup<ordered>(ctx);}
+TOOLS_BENCHMARK(matrix_2d_unbound, ordered_apply) {unbound_apply<ordered>(ctx);}
+TOOLS_BENCHMARK(matrix_2d_unbound, ordered_region) {unbound_region<ordered>(ctx);}
+TOOLS_BENCHMARK(matrix_2d_unbound, ordered_region_range) {unbound_region_range<ordered>(ctx);}
+TOOLS_BENCHMARK(matrix_2d_unbound, chunked_insert) {unbound_insert<chunked>(ctx);}
+TOOLS_BENCHMARK(matrix_2d_unbound, chunked_lookup) {unbound_lookup<chunked>(ctx);}
+TOOLS_BENCHMARK(matrix_2d_unbound, chunked_apply) {unbound_apply<chunked>(ctx);}
+TOOLS_BENCHMARK(matrix_2d_unbound, chunked_region) {unbound_region<chunked>(ctx);}
+TOOLS_BENCHMARK(matrix_2d_unbound, chunked_region_range) {unbound_region_range<chunked>(ctx);}
+
+namespace {
+
+//!A simulation step over a full 1024 x 1024 grid, on a pool of the given
+//!size, to see how parallel_apply scales.
+const unsigned int grid_side=1024;
+
+template<typename S>
+tools::matrix_2d<double, S> filled_grid() {
+
+	tools::matrix_2d<double, S> matrix{grid_side, grid_side};
+	for(unsigned int y=0; y<grid_side; y++) {
+		for(unsigned int x=0; x<grid_side; x++) {
+			matrix.insert(x, y, static_cast<double>(x ^ y));
+		}
+	}
+
+	return matrix;
+}
+
+//!The cell update of the simulation.
+double step(unsigned int _x, unsigned int _y, double _value) {
+
+	return _value*0.99+std::sqrt(_value+_x)-std::sqrt(static_cast<double>(_y));
+}
+
+//!The same step on the calling thread, through a region range.
+template<typename S>
+void grid_sequential(bench::context& ctx) {
+
+	auto matrix=filled_grid<S>();
+	ctx.set_items(matrix.size());
+	ctx.run([&]() {
+		for(auto cell : matrix.region(0, 0, grid_side, grid_side)) {
+			cell.value=step(cell.x, cell.y, cell.value);
+		}
+		bench::do_not_optimize(matrix);
+	});
+}
+
+template<typename S, std::size_t threads>
+void grid_parallel_apply(bench::context& ctx) {
+
+	auto matrix=filled_grid<S>();
+	tools::worker_pool pool{threads};
+	ctx.set_items(matrix.size());
+	ctx.run([&]() {
+		matrix.parallel_apply([](unsigned int _x, unsigned int _y, double& _value) {
+			_value=step(_x, _y, _value);
+		}, pool);
+		bench::do_not_optimize(matrix);
+	});
+}
+
+template<typename S, std::size_t threads>
+void grid_parallel_reduce(bench::context& ctx) {
+
+	const auto matrix=filled_grid<S>();
+	tools::worker_pool pool{threads};
+	ctx.set_items(matrix.size());
+	ctx.run([&]() {
+		bench::do_not_optimize(matrix.parallel_reduce(0.,
+			[](unsigned int _x, unsigned int _y, double _value) {return step(_x, _y, _value);},
+			[](double _a, double _b) {return _a+_b;},
+			pool));
+	});
+}
+
+template<std::size_t threads>
+void unbound_parallel_apply(bench::context& ctx) {
+
+	auto matrix=filled_unbound<chunked>();
+	tools::worker_pool pool{threads};
+	ctx.set_items(matrix.size());
+	ctx.run([&]() {
+		matrix.parallel_apply([](int _x, int _y, int& _value) {
+			_value=static_cast<int>(step(static_cast<unsigned int>(_x+half), static_cast<unsigned int>(_y+half), _value));
+		}, pool);
+		bench::do_not_optimize(matrix);
+	});
+}
+
+}
+
+//On 1, 2, 4 and 8 threads.
+#define TOOLS_MATRIX_2D_PARALLEL_BENCHMARKS(_storage) \
+	TOOLS_BENCHMARK(matrix_2d, _storage##_grid_sequential) {grid_sequential<_storage##_grid>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d, _storage##_grid_parallel_apply_1) {grid_parallel_apply<_storage##_grid, 1>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d, _storage##_grid_parallel_apply_2) {grid_parallel_apply<_storage##_grid, 2>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d, _storage##_grid_parallel_apply_4) {grid_parallel_apply<_storage##_grid, 4>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d, _storage##_grid_parallel_apply_8) {grid_parallel_apply<_storage##_grid, 8>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d, _storage##_grid_parallel_reduce_1) {grid_parallel_reduce<_storage##_grid, 1>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d, _storage##_grid_parallel_reduce_8) {grid_parallel_reduce<_storage##_grid, 8>(ctx);}
+
+namespace {
+
+using sparse_grid=tools::matrix_2d_sparse<double>;
+using dense_grid=tools::matrix_2d_dense<double>;
+using hashed_grid=tools::matrix_2d_hashed<double>;
+
+}
+
+TOOLS_MATRIX_2D_PARALLEL_BENCHMARKS(sparse)
+TOOLS_MATRIX_2D_PARALLEL_BENCHMARKS(dense)
+TOOLS_MATRIX_2D_PARALLEL_BENCHMARKS(hashed)
+
+TOOLS_BENCHMARK(matrix_2d_unbound, chunked_parallel_apply_1) {unbound_parallel_apply<1>(ctx);}
+TOOLS_BENCHMARK(matrix_2d_unbound, chunked_parallel_apply_2) {unbound_parallel_apply<2>(ctx);}
+TOOLS_BENCHMARK(matrix_2d_unbound, chunked_parallel_apply_4) {unbound_parallel_apply<4>(ctx);}
+TOOLS_BENCHMARK(matrix_2d_unbound, chunked_parallel_apply_8) {unbound_parallel_apply<8>(ctx);}
+
+namespace {
+
+//!Saves and loads as a text dump of one "x y item" line per cell would, the
+//!way to compare write_matrix and read_matrix_2d against.
+template<typename S>
+std::string save_text(const tools::matrix_2d<double, S>& _matrix) {
+
+	std::ostringstream out;
+	auto line=[&out](unsigned int _x, unsigned int _y, double _value) {
+		out<<_x<<' '<<_y<<' '<<_value<<'\n';
+	};
+	_matrix.apply_cells(line);
+	return out.str();
+}
+
+template<typename S>
+tools::matrix_2d<double, S> load_text(const std::string& _text) {
+
+	tools::matrix_2d<double, S> matrix{grid_side, grid_side};
+	std::istringstream in(_text);
+	unsigned int x=0, y=0;
+	double value=0.;
+	while(in>>x>>y>>value) {
+		matrix.insert(x, y, value);
+	}
+
+	return matrix;
+}
+
+template<typename S>
+std::string save_binary(const tools::matrix_2d<double, S>& _matrix) {
+
+	std::ostringstream out;
+	tools::write_matrix(out, _matrix);
+	return out.str();
+}
+
+template<typename S>
+void io_save_text(bench::context& ctx) {
+
+	const auto matrix=filled_grid<S>();
+	ctx.set_items(matrix.size());
+	ctx.run([&]() {
+		bench::do_not_optimize(save_text(matrix));
+	});
+}
+
+template<typename S>
+void io_save_binary(bench::context& ctx) {
+
+	const auto matrix=filled_grid<S>();
+	ctx.set_items(matrix.size());
+	ctx.run([&]() {
+		bench::do_not_optimize(save_binary(matrix));
+	});
+}
+
+template<typename S>
+void io_load_text(bench::context& ctx) {
+
+	const auto text=save_text(filled_grid<S>());
+	ctx.set_items(grid_side*grid_side);
+	ctx.run([&]() {
+		bench::do_not_optimize(load_text<S>(text));
+	});
+}
+
+template<typename S>
+void io_load_binary(bench::context& ctx) {
+
+	const auto bytes=save_binary(filled_grid<S>());
+	ctx.set_items(grid_side*grid_side);
+	ctx.run([&]() {
+		std::istringstream in(bytes);
+		bench::do_not_optimize(tools::read_matrix_2d<double, S>(in));
+	});
+}
+
+//!The same sorted cells added one at a time and through the bulk
+//!constructor the loader uses.
+std::vector<tools::matrix_2d_item<double>> sorted_cells() {
+
+	std::vector<tools::matrix_2d_item<double>> result;
+	result.reserve(grid_side*grid_side);
+	for(unsigned int y=0; y<grid_side; y++) {
+		for(unsigned int x=0; x<grid_side; x++) {
+			const auto value=static_cast<double>(x ^ y);
+			result.emplace_back(x, y, value);
+		}
+	}
+
+	return result;
+}
+
+template<typename S>
+void io_insert_sorted(bench::context& ctx) {
+
+	const auto cells=sorted_cells();
+	ctx.set_items(cells.size());
+	ctx.run([&]() {
+		tools::matrix_2d<double, S> matrix{grid_side, grid_side};
+		for(const auto& cell : cells) {
+			matrix.insert(cell.x, cell.y, cell.elem);
+		}
+		bench::do_not_optimize(matrix);
+	});
+}
+
+template<typename S>
+void io_bulk_sorted(bench::context& ctx) {
+
+	const auto cells=sorted_cells();
+	ctx.set_items(cells.size());
+	ctx.run([&]() {
+		bench::do_not_optimize(tools::matrix_2d<double, S>{grid_side, grid_side, std::begin(cells), std::end(cells)});
+	});
+}
+
+//!Maps a saved full grid, then probes every cell of it.
+void io_view_open(bench::context& ctx) {
+
+	bench::temp_dir dir;
+	const auto path=dir.write("grid.tmx", save_binary(filled_grid<sparse_grid>()));
+	ctx.run([&]() {
+		tools::matrix_2d_file_view<double> view{path};
+		bench::do_not_optimize(view.size());
+	});
+}
+
+void io_view_lookup(bench::context& ctx) {
+
+	bench::temp_dir dir;
+	const auto path=dir.write("grid.tmx", save_binary(filled_grid<sparse_grid>()));
+	const tools::matrix_2d_file_view<double> view{path};
+	ctx.set_items(grid_side*grid_side);
+	ctx.run([&]() {
+		double total=0.;
+		for(unsigned int y=0; y<grid_side; y++) {
+			for(unsigned int x=0; x<grid_side; x++) {
+				const auto item=view.find(x, y);
+				if(nullptr!=item) {
+					total+=*item;
+				}
+			}
+		}
+		bench::do_not_optimize(total);
+	});
+}
+
+template<typename S>
+void io_matrix_lookup(bench::context& ctx) {
+
+	const auto matrix=filled_grid<S>();
+	ctx.set_items(grid_side*grid_side);
+	ctx.run([&]() {
+		double total=0.;
+		for(unsigned int y=0; y<grid_side; y++) {
+			for(unsigned int x=0; x<grid_side; x++) {
+				const auto item=matrix.find(x, y);
+				if(nullptr!=item) {
+					total+=*item;
+				}
+			}
+		}
+		bench::do_not_optimize(total);
+	});
+}
+
+}
+
+//Saving and loading a full grid as text and through matrix_2d_io.h.
+#define TOOLS_MATRIX_2D_IO_BENCHMARKS(_storage) \
+	TOOLS_BENCHMARK(matrix_2d_io, _storage##_save_text) {io_save_text<_storage##_grid>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d_io, _storage##_save_binary) {io_save_binary<_storage##_grid>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d_io, _storage##_load_text) {io_load_text<_storage##_grid>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d_io, _storage##_load_binary) {io_load_binary<_storage##_grid>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d_io, _storage##_insert_sorted) {io_insert_sorted<_storage##_grid>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d_io, _storage##_bulk_sorted) {io_bulk_sorted<_storage##_grid>(ctx);} \
+	TOOLS_BENCHMARK(matrix_2d_io, _storage##_lookup) {io_matrix_lookup<_storage##_grid>(ctx);}
+
+TOOLS_MATRIX_2D_IO_BENCHMARKS(sparse)
+TOOLS_MATRIX_2D_IO_BENCHMARKS(dense)
+TOOLS_MATRIX_2D_IO_BENCHMARKS(hashed)
+
+TOOLS_BENCHMARK(matrix_2d_io, view_open) {io_view_open(ctx);}
+TOOLS_BENCHMARK(matrix_2d_io, view_lookup) {io_view_lookup(ctx);}
@@ -0,0 +1,215 @@
+#include "bench.h"
+#include "generators.h"
+
+#include <tools/text_reader.h>
+#include <tools/string_reader.h>
+#include <tools/parallel_line_processor.h>
+#include <tools/pair_file_parser.h>
+#include <tools/pair_file_merger.h>
+
+#include <atomic>
+
+namespace {
+
+const std::size_t line_count=100000;
+
+//!Returns the given amount of "key=value" lines, one in ten a comment.
+std::string random_pairs(std::size_t _lines, const std::string& _prefix) {
+
+	std::string result;
+	for(std::size_t i=0; i<_lines; i++) {
+
+		if(0==i % 10) {
+			result+="#"+bench::random_text(30)+"\n";
+		}
+
+		result+=_prefix+std::to_string(i)+"="+bench::random_text(20)+"\n";
+	}
+
+	return result;
+}
+
+}
+
+TOOLS_BENCHMARK(readers, text_reader) {
+
+	bench::temp_dir dir;
+	const auto contents=bench::random_lines(line_count, 6);
+	const auto path=dir.write("lines.txt", contents);
+
+	ctx.set_bytes(contents.size());
+	ctx.run([&]() {
+		tools::text_reader reader{path, '#', tools::text_reader::ltrim | tools::text_reader::rtrim};
+		std::size_t total=0;
+		for(const auto line : reader.lines()) {
+			total+=line.size();
+		}
+		bench::do_not_optimize(total);
+	});
+}
+
+TOOLS_BENCHMARK(readers, string_reader) {
+
+	const auto contents=bench::random_lines(line_count, 6);
+
+	ctx.set_bytes(contents.size());
+	ctx.run([&]() {
+		tools::string_reader reader{contents, '#', tools::string_reader::ltrim | tools::string_reader::rtrim};
+		std::size_t total=0;
+		for(const auto line : reader.lines()) {
+			total+=line.size();
+		}
+		bench::do_not_optimize(total);
+	});
+}
+
+TOOLS_BENCHMARK(readers, explode_lines_to_buffer) {
+
+	bench::temp_dir dir;
+	const auto contents=bench::random_lines(line_count, 6);
+	const auto path=dir.write("lines.txt", contents);
+
+	ctx.set_bytes(contents.size());
+	ctx.run([&]() {
+		bench::do_not_optimize(tools::explode_lines_to_buffer(path).size());
+	});
+}
+
+namespace {
+
+//!Per line work of the parallel_line_processor benchmarks, enough for the
+//!threads to have something to share.
+std::size_t line_checksum(std::string_view _line) {
+
+	std::size_t result=_line.size();
+	for(const char c : _line) {
+		result=result*31+static_cast<unsigned char>(c);
+	}
+
+	return result;
+}
+
+const auto trim_flags=tools::parallel_line_processor::ltrim | tools::parallel_line_processor::rtrim;
+
+//!The same work on the calling thread through text_reader, on the same file.
+void parallel_baseline(bench::context& ctx) {
+
+	bench::temp_dir dir;
+	const auto contents=bench::random_lines(line_count, 6);
+	const auto path=dir.write("lines.txt", contents);
+
+	ctx.set_bytes(contents.size());
+	ctx.run([&]() {
+		tools::text_reader reader{path, '#', tools::text_reader::ltrim | tools::text_reader::rtrim};
+		std::size_t total=0;
+		for(const auto line : reader.lines()) {
+			total+=line_checksum(line);
+		}
+		bench::do_not_optimize(total);
+	});
+}
+
+template<std::size_t threads>
+void parallel_unordered(bench::context& ctx) {
+
+	bench::temp_dir dir;
+	const auto contents=bench::random_lines(line_count, 6);
+	const auto path=dir.write("lines.txt", contents);
+
+	tools::worker_pool pool{threads};
+
+	ctx.set_bytes(contents.size());
+	ctx.run([&]() {
+		tools::parallel_line_processor processor{path, pool, '#', trim_flags, 256*1024};
+		std::atomic<std::size_t> total{0};
+		processor.for_each_line([&total](std::string_view _line, unsigned int) {
+			total.fetch_add(line_checksum(_line), std::memory_order_relaxed);
+		});
+		bench::do_not_optimize(total.load());
+	});
+}
+
+template<std::size_t threads>
+void parallel_ordered(bench::context& ctx) {
+
+	bench::temp_dir dir;
+	const auto contents=bench::random_lines(line_count, 6);
+	const auto path=dir.write("lines.txt", contents);
+
+	tools::worker_pool pool{threads};
+
+	ctx.set_bytes(contents.size());
+	ctx.run([&]() {
+		tools::parallel_line_processor processor{path, pool, '#', trim_flags, 256*1024};
+		std::size_t total=0;
+		processor.for_each_line_ordered(
+			[](std::string_view _line, unsigned int) {return line_checksum(_line);},
+			[&total](std::size_t _checksum) {total=total*7+_checksum;}
+		);
+		bench::do_not_optimize(total);
+	});
+}
+
+}
+
+//On pools of 1, 2, 4 and 8 threads started once, against text_reader on
+//the calling thread. Each iteration maps and splits the file again.
+TOOLS_BENCHMARK(readers, parallel_line_baseline) {parallel_baseline(ctx);}
+TOOLS_BENCHMARK(readers, parallel_line_processor_1) {parallel_unordered<1>(ctx);}
+TOOLS_BENCHMARK(readers, parallel_line_processor_2) {parallel_unordered<2>(ctx);}
+TOOLS_BENCHMARK(readers, parallel_line_processor_4) {parallel_unordered<4>(ctx);}
+TOOLS_BENCHMARK(readers, parallel_line_processor_8) {parallel_unordered<8>(ctx);}
+TOOLS_BENCHMARK(readers, parallel_line_processor_ordered_1) {parallel_ordered<1>(ctx);}
+TOOLS_BENCHMARK(readers, parallel_line_processor_ordered_2) {parallel_ordered<2>(ctx);}
+TOOLS_BENCHMARK(readers, parallel_line_processor_ordered_4) {parallel_ordered<4>(ctx);}
+TOOLS_BENCHMARK(readers, parallel_line_processor_ordered_8) {parallel_ordered<8>(ctx);}
+
+TOOLS_BENCHMARK(readers, pair_file_parser_load) {
+
+	bench::temp_dir dir;
+	const auto contents=random_pairs(line_count, "key");
+	const auto path=dir.write("pairs.txt", contents);
+
+	ctx.set_bytes(contents.size());
+	ctx.run([&]() {
+		tools::pair_file_parser parser{path, '=', '#'};
+		bench::do_not_optimize(parser.size());
+	});
+}
+
+TOOLS_BENCHMARK(readers, pair_file_parser_lookup) {
+
+	bench::temp_dir dir;
+	const auto path=dir.write("pairs.txt", random_pairs(line_count, "key"));
+	const tools::pair_file_parser parser{path, '=', '#'};
+
+	std::vector<std::string> keys;
+	for(std::size_t i=0; i<1000; i++) {
+		keys.push_back("key"+std::to_string((i*7919) % line_count));
+	}
+
+	ctx.set_items(keys.size());
+	ctx.run([&]() {
+		std::size_t total=0;
+		for(const auto& key : keys) {
+			total+=parser[key].size();
+		}
+		bench::do_not_optimize(total);
+	});
+}
+
+TOOLS_BENCHMARK(readers, pair_file_merger) {
+
+	//Defaults, plus an override layer on a tenth of the keys.
+	bench::temp_dir dir;
+	const tools::pair_file_parser	defaults{dir.write("defaults.txt", random_pairs(line_count, "key")), '=', '#'},
+									overrides{dir.write("user.txt", random_pairs(line_count/10, "key")), '=', '#'};
+
+	ctx.set_items(defaults.size()+overrides.size());
+	ctx.run([&]() {
+		tools::pair_file_merger merger;
+		merger.add_layer(defaults);
+		merger.add_layer(overrides);
+		bench::do_not_optimize(merger.size());
+	});
+}
@@ -0,0 +1,128 @@
+#include "bench.h"
+#include "generators.h"
+
+#include <tools/string_utils.h>
+
+//explode against the view based splitters, and the rest of string_utils.
+
+namespace {
+
+const std::size_t text_size=64*1024;
+
+}
+
+TOOLS_BENCHMARK(string_utils, explode_char) {
+
+	const auto text=bench::random_text(text_size);
+	ctx.set_bytes(text.size());
+	ctx.run([&]() {
+		bench::do_not_optimize(tools::explode(text, ' '));
+	});
+}
+
+TOOLS_BENCHMARK(string_utils, split_view_char) {
+
+	const auto text=bench::random_text(text_size);
+	ctx.set_bytes(text.size());
+	ctx.run([&]() {
+		bench::do_not_optimize(tools::split_view(text, ' '));
+	});
+}
+
+TOOLS_BENCHMARK(string_utils, split_range_char) {
+
+	const auto text=bench::random_text(text_size);
+	ctx.set_bytes(text.size());
+	ctx.run([&]() {
+		std::size_t total=0;
+		for(const auto piece : tools::split_range(text, ' ')) {
+			total+=piece.size();
+		}
+		bench::do_not_optimize(total);
+	});
+}
+
+TOOLS_BENCHMARK(string_utils, explode_string) {
+
+	const auto text=bench::random_text(text_size, ',');
+	const std::string delimiter=",";
+	ctx.set_bytes(text.size());
+	ctx.run([&]() {
+		bench::do_not_optimize(tools::explode(text, delimiter));
+	});
+}
+
+TOOLS_BENCHMARK(string_utils, split_view_string) {
+
+	const auto text=bench::random_text(text_size, ',');
+	ctx.set_bytes(text.size());
+	ctx.run([&]() {
+		bench::do_not_optimize(tools::split_view(text, std::string_view{","}));
+	});
+}
+
+TOOLS_BENCHMARK(string_utils, implode) {
+
+	const auto pieces=tools::explode(bench::random_text(text_size), ' ');
+	ctx.set_items(pieces.size());
+	ctx.run([&]() {
+		bench::do_not_optimize(tools::implode(pieces, ", "));
+	});
+}
+
+TOOLS_BENCHMARK(string_utils, str_trim) {
+
+	const std::string text="  \t "+bench::random_text(64)+" \r\n ";
+	ctx.run([&]() {
+		bench::do_not_optimize(tools::str_trim(text));
+	});
+}
+
+TOOLS_BENCHMARK(string_utils, trim_view) {
+
+	const std::string text="  \t "+bench::random_text(64)+" \r\n ";
+	ctx.run([&]() {
+		bench::do_not_optimize(tools::trim_view(text));
+	});
+}
+
+namespace {
+
+//!Ten search and replacement pairs, built from words of the text so they
+//!do match.
+tools::replacer::table replacement_table(const std::string& _text) {
+
+	tools::replacer::table result;
+	const auto words=tools::split_view(_text, ' ');
+	for(std::size_t i=0; i<10; i++) {
+		result.push_back({std::string{words[i*7]}, "<"+std::to_string(i)+">"});
+	}
+
+	return result;
+}
+
+}
+
+TOOLS_BENCHMARK(string_utils, replace_chained) {
+
+	const auto text=bench::random_text(text_size);
+	const auto table=replacement_table(text);
+	ctx.set_bytes(text.size());
+	ctx.run([&]() {
+		auto copy=text;
+		for(const auto& pair : table) {
+			tools::replace(copy, pair.first, pair.second);
+		}
+		bench::do_not_optimize(copy);
+	});
+}
+
+TOOLS_BENCHMARK(string_utils, replacer) {
+
+	const auto text=bench::random_text(text_size);
+	const tools::replacer replacements{replacement_table(text)};
+	ctx.set_bytes(text.size());
+	ctx.run([&]() {
+		bench::do_not_optimize(replacements.apply(text));
+	});
+}
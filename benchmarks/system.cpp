@@ -0,0 +1,38 @@
+#include "bench.h"
+
+#include <tools/system.h>
+
+TOOLS_BENCHMARK(system, exec) {
+
+#ifdef WINBUILD
+	ctx.skip("not available on windows");
+#else
+	ctx.run([&]() {
+		bench::do_not_optimize(tools::exec("true"));
+	});
+#endif
+}
+
+TOOLS_BENCHMARK(system, exec_process) {
+
+#ifdef WINBUILD
+	ctx.skip("not available on windows");
+#else
+	ctx.run([&]() {
+		bench::do_not_optimize(tools::exec_process("true").wait());
+	});
+#endif
+}
+
+TOOLS_BENCHMARK(system, exec_process_output) {
+
+#ifdef WINBUILD
+	ctx.skip("not available on windows");
+#else
+	//Spawning plus draining 64KB of standard output.
+	ctx.set_bytes(64*1024);
+	ctx.run([&]() {
+		bench::do_not_optimize(tools::exec_process("head -c 65536 /dev/zero").wait());
+	});
+#endif
+}
@@ -0,0 +1,88 @@
+#include "bench.h"
+
+#include <tools/chrono.h>
+#include <tools/histogram.h>
+#include <tools/profiler.h>
+
+//Overhead of the timing tools themselves.
+
+TOOLS_BENCHMARK(timing, steady_clock_now) {
+
+	ctx.run([&]() {
+		bench::do_not_optimize(std::chrono::steady_clock::now());
+	});
+}
+
+TOOLS_BENCHMARK(timing, tsc_clock_now) {
+
+	if(!tools::tsc_clock::is_available()) {
+		ctx.skip("no invariant cycle counter, tsc_clock falls back to steady_clock");
+		return;
+	}
+
+	ctx.run([&]() {
+		bench::do_not_optimize(tools::tsc_clock::now());
+	});
+}
+
+TOOLS_BENCHMARK(timing, chrono_start_stop) {
+
+	tools::chrono timer;
+	ctx.run([&]() {
+		timer.start();
+		timer.stop();
+		bench::do_not_optimize(timer.get_nanoseconds());
+	});
+}
+
+TOOLS_BENCHMARK(timing, tsc_chrono_start_stop) {
+
+	tools::tsc_chrono timer;
+	ctx.run([&]() {
+		timer.start();
+		timer.stop();
+		bench::do_not_optimize(timer.get_nanoseconds());
+	});
+}
+
+TOOLS_BENCHMARK(timing, histogram_record) {
+
+	//Values spread over several powers of two.
+	std::vector<std::uint64_t> values(4096);
+	for(std::size_t i=0; i<values.size(); i++) {
+		values[i]=(i*2654435761u) % 1000000;
+	}
+
+	tools::histogram histogram;
+	ctx.set_items(values.size());
+	ctx.run([&]() {
+		for(const auto v : values) {
+			histogram.record(v);
+		}
+		bench::do_not_optimize(histogram.get_count());
+	});
+}
+
+TOOLS_BENCHMARK(timing, histogram_percentile) {
+
+	tools::histogram histogram;
+	for(std::uint64_t i=0; i<100000; i++) {
+		histogram.record((i*2654435761u) % 1000000);
+	}
+
+	ctx.run([&]() {
+		bench::do_not_optimize(histogram.get_p99());
+	});
+}
+
+TOOLS_BENCHMARK(timing, profiler_zone) {
+
+#ifndef WITH_PROFILER
+	ctx.skip("built without BUILD_PROFILER");
+#else
+	ctx.run([&]() {
+		TOOLS_PROFILE_ZONE("bench");
+	});
+	tools::profiler::get().clear();
+#endif
+}
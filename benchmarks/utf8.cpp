@@ -0,0 +1,119 @@
+#include "bench.h"
+#include "generators.h"
+
+#include <tools/utf8.h>
+
+#include <string_view>
+#include <vector>
+
+namespace {
+
+const std::size_t	text_size=64*1024,
+					catalog_entries=8000;	//!< Entries of the catalogs, as in the i8n benchmarks.
+
+//!The values of the catalog entries, between the braces.
+std::vector<std::string_view> catalog_values(std::string_view _catalog) {
+
+	std::vector<std::string_view> result;
+	for(auto open=_catalog.find("{{"); std::string_view::npos!=open; open=_catalog.find("{{", open)) {
+		open+=2;
+		const auto close=_catalog.find("}}", open);
+		result.push_back(_catalog.substr(open, close-open));
+	}
+
+	return result;
+}
+
+void validate_catalog(bench::context& ctx, const std::string& _text) {
+
+	ctx.set_bytes(_text.size());
+	ctx.run([&]() {
+		bench::do_not_optimize(tools::utf8_validate(_text));
+	});
+}
+
+void length_catalog(bench::context& ctx, const std::string& _text) {
+
+	ctx.set_bytes(_text.size());
+	ctx.run([&]() {
+		bench::do_not_optimize(tools::utf8_length(_text));
+	});
+}
+
+void to_utf32_catalog(bench::context& ctx, const std::string& _text) {
+
+	ctx.set_bytes(_text.size());
+	ctx.run([&]() {
+		bench::do_not_optimize(tools::utf8_to_utf32(_text));
+	});
+}
+
+//!Cuts every value to 16 code points, as for a fixed width column.
+void truncate_catalog(bench::context& ctx, const std::string& _text) {
+
+	const auto values=catalog_values(_text);
+	ctx.set_items(values.size());
+	ctx.run([&]() {
+		for(const auto value : values) {
+			bench::do_not_optimize(tools::utf8_truncate(value, 16));
+		}
+	});
+}
+
+}
+
+TOOLS_BENCHMARK(utf8, validate) {
+
+	const auto text=bench::random_utf8(text_size);
+	ctx.set_bytes(text.size());
+	ctx.run([&]() {
+		bench::do_not_optimize(tools::utf8_validate(text));
+	});
+}
+
+TOOLS_BENCHMARK(utf8, validate_ascii) {
+
+	const auto text=bench::random_text(text_size);
+	ctx.set_bytes(text.size());
+	ctx.run([&]() {
+		bench::do_not_optimize(tools::utf8_validate(text));
+	});
+}
+
+TOOLS_BENCHMARK(utf8, length) {
+
+	const auto text=bench::random_utf8(text_size);
+	ctx.set_bytes(text.size());
+	ctx.run([&]() {
+		bench::do_not_optimize(tools::utf8_length(text));
+	});
+}
+
+TOOLS_BENCHMARK(utf8, to_utf32) {
+
+	const auto text=bench::random_utf8(text_size);
+	ctx.set_bytes(text.size());
+	ctx.run([&]() {
+		bench::do_not_optimize(tools::utf8_to_utf32(text));
+	});
+}
+
+TOOLS_BENCHMARK(utf8, truncate) {
+
+	const auto text=bench::random_utf8(4096);
+	ctx.run([&]() {
+		bench::do_not_optimize(tools::utf8_truncate(text, 1000));
+	});
+}
+
+//The catalogs the i8n benchmarks load are ASCII, the localized ones
+//carry the multibyte letters, combining marks and emoji of translations.
+
+TOOLS_BENCHMARK(utf8, validate_catalog_ascii) {validate_catalog(ctx, bench::random_catalog(0, catalog_entries));}
+TOOLS_BENCHMARK(utf8, validate_catalog_localized) {validate_catalog(ctx, bench::random_localized_catalog(0, catalog_entries));}
+TOOLS_BENCHMARK(utf8, length_catalog_ascii) {length_catalog(ctx, bench::random_catalog(0, catalog_entries));}
+TOOLS_BENCHMARK(utf8, length_catalog_localized) {length_catalog(ctx, bench::random_localized_catalog(0, catalog_entries));}
+TOOLS_BENCHMARK(utf8, to_utf32_catalog_ascii) {to_utf32_catalog(ctx, bench::random_catalog(0, catalog_entries));}
+TOOLS_BENCHMARK(utf8, to_utf32_catalog_localized) {to_utf32_catalog(ctx, bench::random_localized_catalog(0, catalog_entries));}
+TOOLS_BENCHMARK(utf8, truncate_catalog_ascii) {truncate_catalog(ctx, bench::random_catalog(0, catalog_entries));}
+TOOLS_BENCHMARK(utf8, truncate_catalog_localized) {truncate_catalog(ctx, bench::random_localized_catalog(0, catalog_entries));}
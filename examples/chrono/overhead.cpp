@@ -0,0 +1,62 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+
+#include <tools/chrono.h>
+
+//Measures what a start/stop pair and a read cost on each chronometer, by
+//timing many of them with a steady clock.
+template<typename T>
+void measure(const char * _name) {
+
+	const int iterations=1000000;
+	T clock;
+
+	//Warms up caches and, for the time stamp counter, its calibration.
+	for(int i=0; i<1000; i++) {
+		clock.start();
+		clock.stop();
+	}
+
+	unsigned long sink=0;
+
+	auto begin=std::chrono::steady_clock::now();
+	for(int i=0; i<iterations; i++) {
+		clock.start();
+		clock.stop();
+		sink+=clock.get_nanoseconds();
+	}
+	const auto pair_ns=std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now()-begin).count()/iterations;
+
+	clock.start();
+	begin=std::chrono::steady_clock::now();
+	for(int i=0; i<iterations; i++) {
+		sink+=clock.get_nanoseconds();
+	}
+	const auto read_ns=std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now()-begin).count()/iterations;
+
+	//Paused spans are removed at clock resolution, so this only counts the
+	//time spent between each resume and the next pause.
+	clock.start();
+	for(int i=0; i<iterations; i++) {
+		clock.pause();
+		clock.resume();
+	}
+	clock.stop();
+
+	std::cout<<std::setw(12)<<_name
+		<<std::fixed<<std::setprecision(1)
+		<<" start/stop: "<<pair_ns<<" ns"
+		<<", running read: "<<read_ns<<" ns"
+		<<", pause/resume cycle: "<<static_cast<double>(clock.get_nanoseconds())/iterations<<" ns"
+		<<(sink ? "" : " ")<<std::endl;
+}
+
+int main(int, char **) {
+
+	measure<tools::chrono>("steady");
+	measure<tools::tsc_chrono>("tsc");
+	std::cout<<"time stamp counter "<<(tools::tsc_clock::is_available() ? "in use" : "not available, steady clock in use")<<std::endl;
+
+	return 0;
+}
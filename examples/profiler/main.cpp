@@ -0,0 +1,56 @@
+#include <iostream>
+#include <cmath>
+
+#include <tools/profiler.h>
+
+//Builds with or without BUILD_PROFILER: without it the zones vanish and the
+//report is empty.
+
+namespace {
+
+double update(int _steps) {
+
+	TOOLS_PROFILE_ZONE("update");
+
+	double result=0.;
+	for(int i=0; i<_steps; i++) {
+		result+=std::sqrt(static_cast<double>(i));
+	}
+
+	return result;
+}
+
+double frame(int _index) {
+
+	TOOLS_PROFILE_ZONE("frame");
+
+	double result=0.;
+	for(int i=0; i<4; i++) {
+		result+=update(10000*(1+(_index % 3)));
+	}
+
+	return result;
+}
+
+}
+
+int main(int, char **) {
+
+	double sink=0.;
+	for(int i=0; i<100; i++) {
+		sink+=frame(i);
+	}
+
+	for(const auto& zone : tools::profiler::get().stats()) {
+
+		std::cout<<zone.name<<": "<<zone.count<<" zones, "
+			<<zone.total/1000<<" us total, "
+			<<zone.min<<"/"<<zone.p50<<"/"<<zone.p95<<"/"<<zone.p99<<"/"<<zone.max
+			<<" ns min/p50/p95/p99/max"<<std::endl;
+	}
+
+	tools::profiler::get().save_chrome_trace("profile.json");
+	std::cout<<"trace written to profile.json ("<<(sink > 0. ? "ok" : "")<<")"<<std::endl;
+
+	return 0;
+}
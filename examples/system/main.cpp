@@ -10,6 +10,19 @@ int main(int /*argc*/, char ** /*argv*/) {
 
 		std::cout<<ls.code<<":"<<ls.output<<std::endl<<std::endl<<std::endl;
 		std::cout<<fuck.code<<":"<<fuck.output<<std::endl<<std::endl<<std::endl;
+
+		tools::exec_options options;
+		options.input="banana\napple\ncherry\n";
+		options.timeout=std::chrono::seconds(5);
+
+		auto sorted=tools::exec_process("sort; echo done >&2", options).wait();
+		std::cout<<sorted.code<<":"<<sorted.output<<"stderr:"<<sorted.error<<std::endl;
+
+		options=tools::exec_options{};
+		options.timeout=std::chrono::milliseconds(100);
+		auto slow=tools::exec_async("sleep 10", options);
+		auto slow_result=slow.get();
+		std::cout<<"killed "<<slow_result.killed<<", timed out "<<slow_result.timed_out<<std::endl;
 	}
 	catch(tools::exec_exception& e) {
 
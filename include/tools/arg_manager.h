@@ -4,6 +4,8 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <stdexcept>
 
 namespace tools{
@@ -18,6 +20,9 @@ class arg_manager_exception:
 };
 
 //!Argument manager. Facilitates handling of command line arguments.
+
+//!The arguments are indexed once on construction, so looking up arguments,
+//!key=value pairs and --options does not scan the argument list.
 class arg_manager {
 
 	private:
@@ -29,6 +34,12 @@ class arg_manager {
 	//!Class constructor mimicking the main() entrypoint.
 				arg_manager(int argc, char ** argv);
 
+	//!Copy constructor. The indexes view the argument list, so they are rebuilt.
+				arg_manager(const arg_manager&);
+				arg_manager(arg_manager&&)=default;
+	arg_manager&		operator=(const arg_manager&);
+	arg_manager&		operator=(arg_manager&&)=default;
+
 	//!Returns the count of program arguments (program name included).
 	size_t 			size() const {return data.size();}
 
@@ -51,27 +62,56 @@ class arg_manager {
 	bool			exists(const t_arg& v) const {return find_index(v)!=-1;}
 
 	//!Checks if a single argument in format ./executable.out arg1=val1 arg2=val2 arg3=val3
-	bool			value_exists_for(const t_arg& v) const {return find_index_value(v)!=-1;}
+	//!Any argument beginning with the value counts, as in find_index_value.
+	bool			value_exists_for(const t_arg&) const;
 
 	//!Checks if there is an argument following the given one.
 	bool			arg_follows(const t_arg& v) const;
 
 	//!Returns the value of the argument if found. Argument is understood as 
-	//!argument + delimiter + value, as in val=yes. Will throw if the value
-	//!does not exist.
+	//!argument + delimiter + value, as in val=yes, and the value is all that
+	//!follows the first delimiter. Will throw if the value does not exist.
 	std::string 		get_value(const t_arg& c, const char delimiter='=') const;
 
+	//!Same as get_value, without copying the value. The view lives as long
+	//!as the arg_manager.
+	std::string_view	get_value_view(std::string_view, const char delimiter='=') const;
+
+	//!Checks if the option was given as --name, --name=value or --name value.
+	//!The name is given without dashes.
+	bool			has_option(std::string_view _name) const {return options.count(_name);}
+
+	//!Returns the value of the option given as --name=value or as --name
+	//!followed by an argument that does not begin with dashes. The name is
+	//!given without dashes. Will throw if there is no such option or it has
+	//!no value. The view lives as long as the arg_manager.
+	std::string_view	get_option(std::string_view) const;
+
 	private:
 
 	//!Returns the index of the argument that matches partially the value (will 
-	//!return the index of "test" if called with "te". I am not sure this is of
-	//!any use except as a helper to value_exists_for.
+	//!return the index of "test" if called with "te". value_exists_for asks
+	//!the same question through the sorted arguments.
 	int 			find_index_value(const t_arg&) const;
 
 	//!Fills the internal data structures of the class. 
 	void 			init(int argc, char ** argv);
 
+	//!Indexes every argument.
+	void			build_index();
+
+	//!An option given as --name or --name=value.
+	struct option {
+		size_t				index;		//!< Position of the argument.
+		std::string_view	value;		//!< Value after the equal sign.
+		bool				has_value;	//!< True if there was an equal sign.
+	};
+
 	t_arg_list 		data;
+	std::unordered_map<std::string_view, size_t>			positions;	//!< First position of each argument.
+	std::unordered_map<std::string_view, std::string_view>	values;		//!< Value of the first key=value argument of each key.
+	std::unordered_map<std::string_view, option>			options;	//!< First occurrence of each option, by name.
+	std::vector<std::string_view>							sorted;		//!< Every argument, sorted, for prefix searches.
 };
 
 }
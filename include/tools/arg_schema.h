@@ -0,0 +1,209 @@
+#pragma once
+
+#include "arg_manager.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <optional>
+#include <variant>
+#include <limits>
+#include <type_traits>
+#include <stdexcept>
+
+namespace tools{
+
+//!Exception thrown when the arguments do not fit an arg_schema. Carries every
+//!problem found in the arguments, not only the first one.
+class arg_schema_exception:
+	public std::runtime_error {
+	public:
+	//!Class constructor with the list of problems.
+	arg_schema_exception(const std::vector<std::string>&);
+
+	//!Returns every problem found, one per item.
+	const std::vector<std::string>& get_errors() const {return errors;}
+
+	private:
+	std::vector<std::string>	errors;
+};
+
+class arg_values;
+
+//!Declarative description of the options a program takes.
+
+//!Options are given as --name, --name=value or --name value. Anything that
+//!does not begin with two dashes is a positional argument, as is everything
+//!after a lone "--". The arguments are read in a single pass that converts
+//!each value to its type with std::from_chars and gathers every problem
+//!found before throwing.
+class arg_schema {
+
+	public:
+
+	//!Types an option can hold.
+	enum class types {
+		flag,		//!< Takes no value, read as bool.
+		integer,	//!< Stored as long long, read as any integral type it fits in.
+		real,		//!< Read as double or float.
+		text		//!< Read as std::string or std::string_view.
+	};
+
+	//!Description of a single option.
+	struct option {
+		std::string					name;				//!< Name, without the dashes.
+		types						type;				//!< Type of its values.
+		std::optional<std::string>	default_value={};	//!< Value used when not given. Flags take none.
+		bool						required=false;		//!< Missing required options are an error.
+		bool						repeatable=false;	//!< Can be given more than once.
+	};
+
+	//!Adds an option. Throws arg_schema_exception if the name is repeated
+	//!or the option makes no sense, as a flag with a default value.
+	arg_schema&			add(const option&);
+
+	//!Reads the arguments of the arg_manager. Throws arg_schema_exception
+	//!with every problem found.
+	arg_values			parse(const arg_manager&) const;
+
+	//!Reads the arguments as given to main(), without building an
+	//!arg_manager. Throws arg_schema_exception with every problem found.
+	arg_values			parse(int, char **) const;
+
+	private:
+
+	//!Reads the arguments, skipping the first one (the program name).
+	arg_values			parse(const std::vector<std::string_view>&) const;
+
+	std::vector<option>							options;	//!< Options, in the order they were added.
+	std::map<std::string, size_t, std::less<>>	index;		//!< Position of each option by name.
+};
+
+//!Typed values read by an arg_schema.
+class arg_values {
+
+	public:
+
+	//!Returns the value of the option, converted to T. Flags are read as
+	//!bool, integers as any integral type, reals as double or float and text
+	//!as std::string or std::string_view, which lives as long as this
+	//!object. For repeatable options the last value is returned. Throws
+	//!arg_schema_exception if the option does not exist, is of a different
+	//!type, has no value or does not fit in T.
+	template<typename T>
+	T					get(std::string_view _name) const {
+
+		const auto& values=find(_name, type_of<T>()).values;
+		if constexpr(std::is_same<T, bool>::value) {
+			return !values.empty();
+		}
+		else {
+			if(values.empty()) {
+				throw arg_schema_exception({"option --"+std::string{_name}+" has no value"});
+			}
+
+			return convert<T>(_name, values.back());
+		}
+	}
+
+	//!Returns every value given to the option, in order. Same rules as get.
+	template<typename T>
+	std::vector<T>		get_all(std::string_view _name) const {
+
+		const auto& values=find(_name, type_of<T>()).values;
+
+		std::vector<T> result;
+		result.reserve(values.size());
+		for(const auto& v : values) {
+			result.push_back(convert<T>(_name, v));
+		}
+
+		return result;
+	}
+
+	//!Returns true if the option was given in the arguments, defaults aside.
+	//!Throws arg_schema_exception if the option does not exist.
+	bool				is_set(std::string_view _name) const {return count(_name);}
+
+	//!Returns how many times the option was given in the arguments.
+	//!Throws arg_schema_exception if the option does not exist.
+	size_t				count(std::string_view) const;
+
+	//!Returns the arguments that are not options, in order.
+	const std::vector<std::string>&	get_positionals() const {return positionals;}
+
+	private:
+
+	friend class arg_schema;
+
+	using value=std::variant<bool, long long, double, std::string>;
+
+	//!Values of an option.
+	struct slot {
+		arg_schema::types	type;		//!< Declared type.
+		std::vector<value>	values;		//!< Values, given or default.
+		size_t				given;		//!< Times given in the arguments.
+	};
+
+	//!Returns the declared type that reads as T.
+	template<typename T>
+	static constexpr arg_schema::types	type_of() {
+
+		if constexpr(std::is_same<T, bool>::value) {
+			return arg_schema::types::flag;
+		}
+		else if constexpr(std::is_integral<T>::value) {
+			return arg_schema::types::integer;
+		}
+		else if constexpr(std::is_floating_point<T>::value) {
+			return arg_schema::types::real;
+		}
+		else {
+			static_assert(std::is_same<T, std::string>::value || std::is_same<T, std::string_view>::value,
+				"arg_values can only be read as bool, integral, floating point, std::string or std::string_view");
+			return arg_schema::types::text;
+		}
+	}
+
+	//!Converts a stored value to T.
+	template<typename T>
+	static T			convert(std::string_view _name, const value& _value) {
+
+		if constexpr(std::is_same<T, bool>::value) {
+			return std::get<bool>(_value);
+		}
+		else if constexpr(std::is_integral<T>::value) {
+
+			const auto v=std::get<long long>(_value);
+			bool fits=false;
+			if constexpr(std::is_signed<T>::value) {
+				fits=v >= static_cast<long long>(std::numeric_limits<T>::min()) && v <= static_cast<long long>(std::numeric_limits<T>::max());
+			}
+			else {
+				fits=v >= 0 && static_cast<unsigned long long>(v) <= static_cast<unsigned long long>(std::numeric_limits<T>::max());
+			}
+
+			if(!fits) {
+				throw arg_schema_exception({"value of option --"+std::string{_name}+" is out of range"});
+			}
+
+			return static_cast<T>(v);
+		}
+		else if constexpr(std::is_floating_point<T>::value) {
+			return static_cast<T>(std::get<double>(_value));
+		}
+		else {
+			return T{std::get<std::string>(_value)};
+		}
+	}
+
+	//!Returns the slot of the option, throwing if it does not exist or is
+	//!not of the given type.
+	const slot&			find(std::string_view, arg_schema::types) const;
+
+	std::map<std::string, slot, std::less<>>	slots;			//!< Values of each option by name.
+	std::vector<std::string>					positionals;	//!< Non option arguments.
+};
+
+}
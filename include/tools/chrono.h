@@ -1,6 +1,7 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 
 namespace tools{
 
@@ -14,37 +15,145 @@ struct chrono_data {
 	            milliseconds;	//!< Milliseconds elapsed.
 };
 
+//!Clock that reads the processor time stamp counter, cheaper to read than
+//!the operating system clocks.
+
+//!Ticks are converted to nanoseconds with a ratio measured against
+//!std::chrono::steady_clock the first time the clock is read. When there is
+//!no usable counter (not x86 nor ARM64, or an x86 counter that is not
+//!invariant) it reads std::chrono::steady_clock instead.
+struct tsc_clock {
+
+	using rep=std::int64_t;
+	using period=std::nano;
+	using duration=std::chrono::nanoseconds;
+	using time_point=std::chrono::time_point<tsc_clock>;
+	static constexpr bool is_steady=true;
+
+	//!Returns the current time.
+	static time_point		now() noexcept {
+
+		const auto& cal=calibration();
+		if(!cal.available) {
+			return time_point{std::chrono::duration_cast<duration>(std::chrono::steady_clock::now().time_since_epoch())};
+		}
+
+		return time_point{duration{static_cast<rep>(static_cast<double>(ticks()-cal.base)*cal.ns_per_tick)}};
+	}
+
+	//!Returns true if a hardware counter is in use.
+	static bool				is_available() {return calibration().available;}
+
+	//!Returns the raw counter.
+	static std::uint64_t	ticks() noexcept;
+
+	private:
+
+	//!Conversion from ticks to nanoseconds.
+	struct calibration_data {
+		bool			available;		//!< True if the counter can be used.
+		std::uint64_t	base;			//!< Counter at calibration, the clock epoch.
+		double			ns_per_tick;	//!< Nanoseconds per tick.
+	};
+
+	//!Returns the conversion, measuring it on the first call.
+	static const calibration_data&	calibration() {
+
+		static const calibration_data data=calibrate();
+		return data;
+	}
+
+	//!Measures the counter against the steady clock.
+	static calibration_data			calibrate();
+};
+
 //!Simple chronometer.
 
 //!Returns the time elapsed since "start" was called as an integer.
 //!There is not need to reset it: after stop, each call to start is valid.
-//!In this case, time is "real" or "user" time.
-
+//!In this case, time is "real" or "user" time, measured by a monotonic
+//!clock so it is not affected by changes to the wall clock. Paused time is
+//!accounted at the resolution of the clock, so pausing and resuming many
+//!times does not accumulate error.
 
-class chrono {
+template<typename C>
+class basic_chrono {
 
 	public:
 
+	using clock=C;
+	using duration=typename C::duration;
+
 	//!Starts the count.
-	void            start();
+	void            start() {
+
+		begin=clock::now();
+		running=true;
+		paused=false;
+	}
 
 	//!Stops the counter.
-	void            stop();
+	void            stop() {
+
+		end=paused ? pause_point : clock::now();
+		running=false;
+		paused=false;
+	}
 
 	//!Pauses the counter.
-	void            pause();
+	void            pause() {
+
+		if(paused || !is_running()) {
+
+			return;
+		}
+
+		paused=true;
+		pause_point=clock::now();
+	}
 
 	//!Resumes the counter.
-	void            resume();
+	void            resume() {
+
+		if(!paused) {
+
+			return;
+		}
+
+		begin+=clock::now()-pause_point;
+		paused=false;
+	}
+
+	//!Returns the time elapsed as the given std::chrono::duration.
+	template<typename T>
+	T               get_duration() const {return std::chrono::duration_cast<T>(elapsed());}
+
+	//!Returns the total of ns elapsed.
+	unsigned long int get_nanoseconds() const {return get_duration<std::chrono::nanoseconds>().count();}
+
+	//!Returns the total of us elapsed.
+	unsigned long int get_microseconds() const {return get_duration<std::chrono::microseconds>().count();}
 
 	//!Returns the total of ms elapsed.
-	unsigned long int get_milliseconds() const;
+	unsigned long int get_milliseconds() const {return get_duration<std::chrono::milliseconds>().count();}
 
 	//!Returns the total of seconds elapsed.
-	unsigned long int get_seconds() const;
+	unsigned long int get_seconds() const {return get_duration<std::chrono::seconds>().count();}
 
 	//!Gets a full structure of hours, minutes, seconds and milliseconds.
-	chrono_data     get_full();
+	chrono_data     get_full() const {
+
+		auto t=get_milliseconds();
+
+		//Hyper lazy.
+		auto ms=t % 1000;
+
+		auto seconds=(t / 1000) % 60;
+		auto minutes=(t / (1000*60)) % 60;
+		auto hours=(t / (1000*60*60)) % 24;
+
+		return {(unsigned)hours, (unsigned)minutes, (unsigned)seconds, (unsigned)ms};
+	}
 
 	//!Returns true if started.
 	bool            is_running() const {return running;}
@@ -52,18 +161,44 @@ class chrono {
 	//!Returns true if paused.
 	bool            is_paused() const {return paused;}
 
-	void            reset();
+	void            reset() {
+
+		begin=tp{};
+		end=tp{};
+		pause_point=tp{};
+		running=false;
+		paused=false;
+	}
 
 	private:
 
-	using tp=std::chrono::system_clock::time_point;
+	using tp=typename C::time_point;
+
+	//!Returns the time elapsed at the resolution of the clock.
+	duration        elapsed() const {
+
+		if(running) {
+
+			return (paused ? pause_point : clock::now()) - begin;
+		}
 
-	tp              begin,		//!< Internal starting time point.
-	                end,		//!< Internal end time point.
-	                pause_point;      //!< Internal pause moment.
+		return end - begin;
+	}
+
+	tp              begin{},		//!< Internal starting time point.
+	                end{},		//!< Internal end time point.
+	                pause_point{};      //!< Internal pause moment.
 	bool            running{false},
 	                paused{false}; //!< State flag.
 };
 
-}
+//!Chronometer on std::chrono::steady_clock.
+using chrono=basic_chrono<std::chrono::steady_clock>;
+
+//!Chronometer on the time stamp counter, for timing very short spans.
+using tsc_chrono=basic_chrono<tsc_clock>;
 
+extern template class basic_chrono<std::chrono::steady_clock>;
+extern template class basic_chrono<tsc_clock>;
+
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <tools/system.h>
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <atomic>
+
+namespace tools{
+
+//!Runs a queue of commands through exec_process, a bounded amount at a
+//!time. Results are handed back on the calling thread as each command
+//!finishes, so a long queue can be reported while it runs.
+class exec_pool {
+
+	public:
+
+	using duration=std::chrono::microseconds;
+
+	//!The outcome of a queued command.
+	struct job_result {
+		size_t				index;		//!< Position of the command in the queue.
+		std::string			command;	//!< The command.
+		exec_result			result;		//!< Exit code and captured output.
+		duration			elapsed;	//!< Time from spawn to exit.
+	};
+
+	//!Figures of a whole run.
+	struct stats {
+		size_t				jobs=0,			//!< Commands that ran.
+							failed=0,		//!< Commands with non zero codes or killed.
+							timed_out=0;	//!< Commands killed by their timeout.
+		duration			wall{0},		//!< Time taken by the whole run.
+							total{0},		//!< Sum of the time of every command.
+							min{0},			//!< Fastest command.
+							max{0},			//!< Slowest command.
+							mean{0};		//!< Average command time.
+	};
+
+	//!Creates a pool that runs up to the given amount of commands at once.
+	//!Zero uses the hardware thread count.
+						exec_pool(size_t=0);
+
+	//!Queues a command, returning its index.
+	size_t				add(const std::string&, const exec_options& ={});
+
+	//!Returns the amount of queued commands.
+	size_t				size() const {return jobs.size();}
+
+	//!Returns the maximum amount of commands that run at once.
+	size_t				get_concurrency() const {return concurrency;}
+
+	//!Runs every queued command and empties the queue. The callback is
+	//!called on the calling thread with each result as it completes, in no
+	//!particular order. If spawning a command fails or the callback throws,
+	//!the rest of the queue is cancelled and the first exception is rethrown
+	//!once the running commands are gone.
+	stats				run(const std::function<void(const job_result&)>&);
+
+	//!Runs every queued command and returns the results in queue order.
+	std::vector<job_result>	run(stats * _stats=nullptr);
+
+	//!Kills the running commands and drops the rest of the queue. Can be
+	//!called from the callback or any other thread.
+	void				cancel();
+
+	private:
+
+	//!A queued command.
+	struct job {
+		std::string			command;	//!< Shell command.
+		exec_options		options;	//!< Input and timeout.
+	};
+
+	size_t						concurrency;	//!< Maximum running commands.
+	std::vector<job>			jobs;			//!< Queue.
+	std::mutex					mutex;			//!< Guards the running list.
+	std::vector<exec_process*>	running;		//!< Processes that can be killed by cancel.
+	std::atomic<bool>			cancelled{false};	//!< Set by cancel.
+};
+
+}
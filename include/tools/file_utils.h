@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <fstream>
 
 #if __has_include(<filesystem>)
@@ -23,4 +24,45 @@ namespace tools{
 //!Dumps the contents of the file to a string.
 std::string	dump_file(const std::string&);
 
+//!Read-only view of the whole contents of a file, memory mapped where the
+//!platform allows it and read into memory elsewhere. Movable, not copyable.
+class mapped_file {
+
+	public:
+
+	//!Default constructor for a closed file.
+						mapped_file()=default;
+
+	//!Maps the given file. Throws std::runtime_error if it cannot be opened.
+						mapped_file(const std::string&);
+
+						mapped_file(const mapped_file&)=delete;
+						mapped_file(mapped_file&&) noexcept;
+						~mapped_file();
+
+	mapped_file&		operator=(const mapped_file&)=delete;
+	mapped_file&		operator=(mapped_file&&) noexcept;
+
+	//!Maps the given file, closing any previous one. Returns true on success.
+	bool				open(const std::string&);
+
+	//!Unmaps the file. Views obtained from "data" are no longer valid.
+	void				close();
+
+	//!Returns true if a file is mapped.
+	bool				is_open() const {return opened;}
+
+	//!Returns the contents of the file.
+	std::string_view	data() const {return {begin, length};}
+
+	private:
+
+	const char *		begin{nullptr};	//!< Start of the contents.
+	size_t				length{0};		//!< Size of the contents.
+	bool				opened{false};	//!< True when a file is mapped.
+#ifdef WINBUILD
+	std::string			contents;		//!< Contents, as there is no mapping.
+#endif
+};
+
 }
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace tools{
+
+//!Log bucketed histogram for latencies and other positive values, in the
+//!manner of HdrHistogram.
+
+//!Values below 128 get a bucket each. Above that, every power of two range is
+//!split into 128 buckets, so any value is known to within 1/128 (0.8%) of
+//!itself. Memory is fixed at construction and recording is a couple of
+//!shifts and an increment. The unit is up to the caller (nanoseconds,
+//!microseconds...). Not thread safe: keep one per thread and merge them to
+//!report.
+class histogram {
+
+	public:
+
+	//!Bits of precision kept for each value.
+	static constexpr unsigned		precision_bits=7;
+
+	//!Buckets per power of two.
+	static constexpr std::uint64_t	sub_buckets=std::uint64_t{1} << precision_bits;
+
+	//!Total amount of buckets, enough for any 64 bit value.
+	static constexpr std::size_t	bucket_count=(64-precision_bits+1)*sub_buckets;
+
+	//!Creates an empty histogram.
+							histogram();
+
+	//!Records a value the given amount of times.
+	void					record(std::uint64_t _value, std::uint64_t _times=1) {
+
+		counts[bucket_index(_value)]+=_times;
+		total+=_times;
+		sum+=_value*_times;
+
+		if(_value < min) {
+			min=_value;
+		}
+
+		if(_value > max) {
+			max=_value;
+		}
+	}
+
+	//!Adds the values recorded by another histogram.
+	void					merge(const histogram&);
+
+	//!Forgets every value.
+	void					reset();
+
+	//!Returns the amount of recorded values.
+	std::uint64_t			get_count() const {return total;}
+
+	//!Returns the smallest value, zero if empty.
+	std::uint64_t			get_min() const {return total ? min : 0;}
+
+	//!Returns the largest value, zero if empty.
+	std::uint64_t			get_max() const {return max;}
+
+	//!Returns the mean of the recorded values, zero if empty.
+	double					get_mean() const {return total ? static_cast<double>(sum)/static_cast<double>(total) : 0.;}
+
+	//!Returns the value below which the given percentage (0 to 100) of the
+	//!values fall. The result is the top of its bucket, never above the
+	//!largest value recorded. Zero if empty.
+	std::uint64_t			get_percentile(double) const;
+
+	//!Returns the median.
+	std::uint64_t			get_p50() const {return get_percentile(50.);}
+
+	//!Returns the 95th percentile.
+	std::uint64_t			get_p95() const {return get_percentile(95.);}
+
+	//!Returns the 99th percentile.
+	std::uint64_t			get_p99() const {return get_percentile(99.);}
+
+	//!Returns a one line summary with count, min, mean, percentiles and max,
+	//!followed by a line per non empty bucket if asked to.
+	std::string				to_text(bool=false) const;
+
+	//!Returns the same data as to_text as a JSON object, with the buckets as
+	//!an array of [lowest, highest, count] triplets.
+	std::string				to_json(bool=false) const;
+
+	//!Returns the bucket a value falls into.
+	static std::size_t		bucket_index(std::uint64_t _value) {
+
+		if(_value < sub_buckets) {
+			return _value;
+		}
+
+		const unsigned shift=highest_bit(_value)-precision_bits;
+		return (shift+1)*sub_buckets+((_value >> shift) & (sub_buckets-1));
+	}
+
+	//!Returns the lowest value of the bucket.
+	static std::uint64_t	bucket_lowest(std::size_t);
+
+	//!Returns the highest value of the bucket.
+	static std::uint64_t	bucket_highest(std::size_t);
+
+	private:
+
+	//!Returns the position of the highest set bit of a non zero value.
+	static unsigned			highest_bit(std::uint64_t _value) {
+
+#if defined(__GNUC__)
+		return 63-__builtin_clzll(_value);
+#else
+		unsigned result=0;
+		while(_value >>= 1) {
+			++result;
+		}
+		return result;
+#endif
+	}
+
+	std::vector<std::uint64_t>	counts;		//!< Values per bucket.
+	std::uint64_t				total,		//!< Recorded values.
+								sum,		//!< Sum of the recorded values.
+								min,		//!< Smallest value.
+								max;		//!< Largest value.
+};
+
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+//!Counts a call to the enclosing public entry point, named by the given
+//!string literal, along with the heap allocations made until the end of the
+//!scope. Expands to nothing unless the library is built with instrumentation
+//!(BUILD_INSTRUMENTATION in cmake, which defines WITH_INSTRUMENTATION).
+#ifdef WITH_INSTRUMENTATION
+#define TOOLS_INSTRUMENT_CONCAT_IMPL(_a, _b) _a##_b
+#define TOOLS_INSTRUMENT_CONCAT(_a, _b) TOOLS_INSTRUMENT_CONCAT_IMPL(_a, _b)
+#define TOOLS_INSTRUMENT(_name) \
+	static tools::instrumentation_point TOOLS_INSTRUMENT_CONCAT(tools_instrument_point_, __LINE__){_name}; \
+	tools::instrumentation_scope TOOLS_INSTRUMENT_CONCAT(tools_instrument_scope_, __LINE__){TOOLS_INSTRUMENT_CONCAT(tools_instrument_point_, __LINE__)}
+#else
+#define TOOLS_INSTRUMENT(_name) do {} while(0)
+#endif
+
+namespace tools{
+
+//!Counters of an entry point.
+struct instrumentation_stats {
+	std::string		name;			//!< Entry point name.
+	std::uint64_t	calls,			//!< Times it was called.
+					allocations,	//!< Heap allocations made inside, nested calls included.
+					bytes;			//!< Bytes requested by those allocations.
+};
+
+//!Heap allocations made by a thread.
+struct instrumentation_allocations {
+	std::uint64_t	count,		//!< Allocations.
+					bytes;		//!< Bytes requested.
+};
+
+//!Collects the counters of every instrumented entry point.
+
+//!When built with WITH_INSTRUMENTATION the library replaces the global
+//!operator new to count, per thread, the allocations and bytes requested,
+//!and each entry point adds what happened while it ran to the counters of
+//!its thread. Counters are only written by their own thread, so recording
+//!takes no locks, and reading them from any thread is safe. Totals are
+//!dumped to standard error at exit unless disabled.
+class instrumentation {
+
+	public:
+
+	//!Most entry points that can be registered. Later ones are not counted.
+	static constexpr std::size_t	max_points=128;
+
+	//!Returns the counters of every entry point, summed over all threads
+	//!and merged by name, sorted by name. Entry points never called are
+	//!left out.
+	static std::vector<instrumentation_stats>	stats();
+
+	//!Returns the same counters, only for the calling thread. Meant for
+	//!allocation budgets in tests, where other threads would add noise.
+	static std::vector<instrumentation_stats>	thread_stats();
+
+	//!Returns the counters of an entry point for the calling thread, zeros
+	//!if it was never called.
+	static instrumentation_stats	thread_stats(const std::string&);
+
+	//!Returns the allocations made by the calling thread so far, inside an
+	//!entry point or not.
+	static instrumentation_allocations	thread_allocations();
+
+	//!Zeroes the counters of every thread.
+	static void						reset();
+
+	//!Returns the counters as a table, one entry point per line.
+	static std::string				to_text();
+
+	//!Sets whether the table is written to standard error at exit. It is
+	//!by default, if any entry point was called.
+	static void						set_dump_at_exit(bool);
+
+	//!Registers an entry point, returning its slot. Used by
+	//!instrumentation_point.
+	static std::size_t				add_point(const char *);
+
+	//!Counters of an entry point in a thread.
+	struct slot {
+		std::atomic<std::uint64_t>	calls{0},		//!< Calls.
+									allocations{0},	//!< Allocations.
+									bytes{0};		//!< Bytes.
+	};
+
+	//!Counters of a thread. They outlive the thread, so its figures are kept.
+	struct thread_record {
+		std::array<slot, max_points>	slots;		//!< One per entry point.
+	};
+
+	//!Returns the record of the calling thread, creating it on first use.
+	static thread_record&			local_record();
+
+	//!Adds to a counter that only the calling thread writes.
+	static void						bump(std::atomic<std::uint64_t>& _counter, std::uint64_t _value) {
+
+		_counter.store(_counter.load(std::memory_order_relaxed)+_value, std::memory_order_relaxed);
+	}
+};
+
+//!A registered entry point. Usually a function local static created by
+//!TOOLS_INSTRUMENT, so it is registered once on first call.
+class instrumentation_point {
+
+	public:
+
+	//!Registers the entry point. The name must outlive the program, as a
+	//!string literal.
+	explicit					instrumentation_point(const char * _name)
+		:index{instrumentation::add_point(_name)} {}
+
+	std::size_t					index;	//!< Slot, max_points if there was no room.
+};
+
+//!Counts a call to an entry point and the allocations made while it lives.
+class instrumentation_scope {
+
+	public:
+
+	//!Counts the call and takes note of the allocations made so far.
+	explicit					instrumentation_scope(const instrumentation_point&);
+
+	//!Adds the allocations made since construction.
+								~instrumentation_scope();
+
+								instrumentation_scope(const instrumentation_scope&)=delete;
+	instrumentation_scope&		operator=(const instrumentation_scope&)=delete;
+
+	private:
+
+	instrumentation::slot *		counters;	//!< Counters of the entry point in this thread, null if not counted.
+	instrumentation_allocations	begin;		//!< Allocations of the thread at construction.
+};
+
+}
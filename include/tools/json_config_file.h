@@ -3,6 +3,7 @@
 #include <rapidjson/document.h>
 #include <tools/string_utils.h>
 #include <tools/json.h>
+#include <tools/instrumentation.h>
 
 #include <iostream>
 #include <sstream>
@@ -27,19 +28,19 @@ class json_config_file {
 	void                set_filepath(const std::string& _path) {path=_path;}
 
 	//!Returns an integer from the given path. Will throw if the path does not exist or the value is not of the asked type.
-	int 				int_from_path(const std::string& ppath) const {return token_from_path(ppath).GetInt();}
+	int 				int_from_path(const std::string& ppath) const {TOOLS_INSTRUMENT("json_config_file::int_from_path"); return token_from_path(ppath).GetInt();}
 
 	//!Returns a boolean from the given path. Will throw if the path does not exist or the value is not of the asked type.
-	bool 				bool_from_path(const std::string& ppath) const {return token_from_path(ppath).GetBool();}
+	bool 				bool_from_path(const std::string& ppath) const {TOOLS_INSTRUMENT("json_config_file::bool_from_path"); return token_from_path(ppath).GetBool();}
 
 	//!Returns an string from the given path. Will throw if the path does not exist or the value is not of the asked type.
-	std::string 		string_from_path(const std::string& ppath) const {return token_from_path(ppath).GetString();}
+	std::string 		string_from_path(const std::string& ppath) const {TOOLS_INSTRUMENT("json_config_file::string_from_path"); return token_from_path(ppath).GetString();}
 
 	//!Returns a double from the given path. Will throw if the path does not exist or the value is not of the asked type.
-	double				double_from_path(const std::string& ppath) const {return token_from_path(ppath).GetDouble();}
+	double				double_from_path(const std::string& ppath) const {TOOLS_INSTRUMENT("json_config_file::double_from_path"); return token_from_path(ppath).GetDouble();}
 
 	//!Returns a float from the given path. Will throw if the path does not exist or the value is not of the asked type.
-	float				float_from_path(const std::string& ppath) const {return token_from_path(ppath).GetFloat();}
+	float				float_from_path(const std::string& ppath) const {TOOLS_INSTRUMENT("json_config_file::float_from_path"); return token_from_path(ppath).GetFloat();}
 
 	//!Returns full json token (as a vector, or another map) from the given path. Will throw if the path does not exist or the value is not of the asked type.
 	const rapidjson::Value&	token_from_path(const std::string& c) const;
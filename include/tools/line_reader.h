@@ -0,0 +1,299 @@
+#pragma once
+
+#include <tools/string_utils.h>
+#include <tools/file_utils.h>
+
+#include <string>
+#include <string_view>
+#include <istream>
+#include <iterator>
+#include <type_traits>
+
+namespace tools{
+
+//!Line source over the contents of a memory mapped file.
+class mapped_line_source {
+
+	public:
+
+	//!Maps the file. Returns true on success.
+	bool				open(const std::string&);
+
+	//!Returns true if a file is mapped.
+	bool				is_open() const {return file.is_open();}
+
+	//!Reads the next raw line, without its newline. Returns false when
+	//!there are no more lines. The view lives as long as the mapping.
+	bool				next(std::string_view&);
+
+	//!Goes back to the first line.
+	void				rewind() {position=0;}
+
+	private:
+
+	mapped_file			file;			//!< Mapped contents.
+	size_t				position{0};	//!< Offset of the next line.
+};
+
+//!Line source over a string owned by the source.
+class string_line_source {
+
+	public:
+
+	//!Takes a copy of the string and goes back to its first line.
+	void				set(const std::string&);
+
+	//!Always true, as a string is always available.
+	bool				is_open() const {return true;}
+
+	//!Reads the next raw line, without its newline. Returns false when
+	//!there are no more lines. The view lives until "set" is called.
+	bool				next(std::string_view&);
+
+	//!Goes back to the first line.
+	void				rewind() {position=0;}
+
+	private:
+
+	std::string			contents;		//!< Owned contents.
+	size_t				position{0};	//!< Offset of the next line.
+};
+
+//!Line source over a string_view owned by someone else.
+class view_line_source {
+
+	public:
+
+	//!Assigns the data and goes back to its first line.
+	void				set(std::string_view _data) {data=_data; position=0;}
+
+	//!Always true, as a view is always available.
+	bool				is_open() const {return true;}
+
+	//!Reads the next raw line, without its newline. Returns false when
+	//!there are no more lines. The view lives as long as the data.
+	bool				next(std::string_view&);
+
+	//!Goes back to the first line.
+	void				rewind() {position=0;}
+
+	private:
+
+	std::string_view	data;			//!< Data being read.
+	size_t				position{0};	//!< Offset of the next line.
+};
+
+//!Line source over any std::istream, which must outlive the source.
+class stream_line_source {
+
+	public:
+
+	//!Assigns the stream to read from, remembering its current position.
+	void				set(std::istream&);
+
+	//!Returns true if there is a stream that has not failed.
+	bool				is_open() const {return nullptr!=stream && !stream->bad();}
+
+	//!Reads the next raw line, without its newline. Returns false when
+	//!there are no more lines. The view lives until the next call.
+	bool				next(std::string_view&);
+
+	//!Goes back to the position the stream had when it was assigned.
+	void				rewind();
+
+	private:
+
+	std::istream *		stream{nullptr};	//!< Stream being read.
+	std::streampos		start{0};			//!< Position to rewind to.
+	std::string			buffer;				//!< Last line read.
+};
+
+//!Splits the next line off the data at the given position, moving the
+//!position past its newline. Returns false when the data is exhausted. A last
+//!line without newline is still returned.
+bool					next_line(std::string_view, size_t&, std::string_view&);
+
+//!Line scanning engine shared by text_reader and string_reader. Reads lines
+//!from the source as views, applying trimming flags and skipping empty and
+//!comment lines.
+template<typename source>
+class line_reader {
+
+	public:
+
+	enum		flags{
+		none=0,
+		ltrim=1, //left trim each line
+		rtrim=2, //right trim each line
+		ignorewscomment=4 //ignores whitespace when looking for the comment character. Has no effect it ltrim is active.
+	};
+
+	//!Constructs a reader with the given comment char and flags.
+				line_reader(char _comment='#', int _flags=none)
+		:comment{_comment}, line_flags{_flags} {
+
+	}
+
+	//!Stores the next non-empty, non-comment line in the parameter and
+	//!returns true. Returns false when no more lines are available.
+	bool				next(std::string_view& _line) {
+
+		std::string_view line;
+		while(src.next(line)) {
+
+			++line_number;
+
+			if(line_flags & ltrim) {
+				line=ltrim_view(line);
+			}
+
+			if(line_flags & rtrim) {
+				line=rtrim_view(line);
+			}
+
+			if(line.empty() || is_comment(line)) {
+				continue;
+			}
+
+			_line=line;
+			return true;
+		}
+
+		finished=true;
+		return false;
+	}
+
+	//!Returns the source, to assign its contents.
+	source&				get_source() {return src;}
+
+	//!Returns the source.
+	const source&		get_source() const {return src;}
+
+	//!Goes back to the first line.
+	void				rewind() {
+
+		src.rewind();
+		line_number=0;
+		finished=false;
+	}
+
+	//!Returns the current line number (comments and blank lines are considered).
+	unsigned int		get_line_number() const {return line_number;}
+
+	//!Returns true once "next" has run out of lines.
+	bool				is_finished() const {return finished;}
+
+	//!Returns the current comment char.
+	char				get_comment() const {return comment;}
+
+	//!Sets a new commenting character.
+	void				set_comment(char _v) {comment=_v;}
+
+	//!Returns the flags.
+	int					get_flags() const {return line_flags;}
+
+	//!Sets the flags.
+	void				set_flags(int _v) {line_flags=_v;}
+
+	private:
+
+	//!Returns true if the line is a comment. Assumes that the line has length.
+	bool				is_comment(std::string_view _line) const {
+
+		if(line_flags & ignorewscomment && !(line_flags & ltrim)) {
+
+			_line=ltrim_view(_line);
+			return _line.size() && _line.front()==comment;
+		}
+
+		return _line.front()==comment;
+	}
+
+	source				src;				//!< Byte source.
+	char				comment;			//!< Current comment char.
+	int					line_flags;			//!< Trimming and comment flags.
+	unsigned int		line_number{0};		//!< Current line number.
+	bool				finished{false};	//!< True when the source is exhausted.
+};
+
+//!Input range over the lines of any reader with a
+//!"bool read_line(std::string_view&)" method, such as text_reader or
+//!string_reader. Advancing reads from the reader, so only one pass is
+//!possible and each view lives as its reader documents.
+template<typename reader>
+class line_range {
+
+	public:
+
+	//!Input iterator over the lines.
+	class iterator {
+
+		public:
+
+		using iterator_category=std::input_iterator_tag;
+		using value_type=std::string_view;
+		using difference_type=std::ptrdiff_t;
+		using pointer=const std::string_view*;
+		using reference=const std::string_view&;
+
+		//!Constructs an end iterator.
+							iterator()=default;
+
+		//!Constructs an iterator on the next line of the reader.
+		explicit			iterator(reader& _reader)
+			:source{&_reader} {
+
+			++(*this);
+		}
+
+		reference			operator*() const {return line;}
+		pointer				operator->() const {return &line;}
+
+		iterator&			operator++() {
+
+			if(!source->read_line(line)) {
+				source=nullptr;
+			}
+
+			return *this;
+		}
+
+		void				operator++(int) {++(*this);}
+		bool				operator==(const iterator& _o) const {return source==_o.source;}
+		bool				operator!=(const iterator& _o) const {return source!=_o.source;}
+
+		private:
+
+		reader *			source{nullptr};	//!< Reader, null when exhausted.
+		std::string_view	line;				//!< Current line.
+	};
+
+	explicit				line_range(reader& _reader):source{_reader} {}
+	iterator				begin() {return iterator{source};}
+	iterator				end() {return iterator{};}
+
+	private:
+
+	reader&					source;		//!< Reader to take lines from.
+};
+
+//!Calls the callback with each remaining line of the reader as a string_view.
+//!If the callback returns a bool, iteration stops when it returns false.
+template<typename reader, typename callback>
+void					for_each_line(reader& _reader, callback&& _callback) {
+
+	std::string_view line;
+	while(_reader.read_line(line)) {
+
+		if constexpr (std::is_same<decltype(_callback(line)), bool>::value) {
+			if(!_callback(line)) {
+				return;
+			}
+		}
+		else {
+			_callback(line);
+		}
+	}
+}
+
+}
@@ -1,6 +1,13 @@
 #pragma once
 #include "compatibility_patches.h"
+#include "matrix_2d_ranges.h"
+#include "worker_pool.h"
 #include <map>
+#include <unordered_map>
+#include <vector>
+#include <optional>
+#include <utility>
+#include <algorithm>
 #include <stdexcept>
 #include <string>
 
@@ -73,19 +80,515 @@ struct matrix_2d_item {
 	}
 };
 
-//!Implements a 2d matrix with fixed dimensions in terms of a std::map, so 
-//!storage is used only for the inserted items. Its implementation only
-//!allows for positive indexes.
+//!Storage policies for matrix_2d. Each one keeps the items by cell index
+//!(y * width + x) and provides:
+//!	prepare(cells): called once on an empty storage with the cell count.
+//!	find(index): pointer to the item, nullptr if the cell is empty.
+//!	try_emplace(index, args...): builds the item in place only if the cell is
+//!		empty. Returns a pointer to the item in the cell and true if it was
+//!		built.
+//!	try_emplace_back(index, args...): the same, in constant time when the
+//!		index is past those of every item.
+//!	erase(index): removes the item, returns false if there was none.
+//!	size(), clear().
+//!	for_each(f): calls f(index, item) for every item.
+//!	for_each_part(part, parts, cells, f): calls f(index, item) for the items
+//!		of one of parts disjoint slices of the storage, by index range or
+//!		by hash bucket, for a matrix of the given cell count. Const and
+//!		non-const, as for_each.
+//!	relocate(cells, to): prepares the storage for a new cell count and
+//!		moves every item to the index set by to(index, new_index), which
+//!		returns false for the items to drop. Indexes keep their order.
+//!	next_in(cursor, x0, y0, x1, y1, w, after): moves the cursor to the
+//!		first item with x0 <= x < x1 and y0 <= y < y1, row by row, or to
+//!		the one after it if asked, for a matrix w cells wide. Returns the
+//!		item, nullptr if none is left. The cursor type holds the x and y of
+//!		the item and whatever else makes the next step cheap.
+
+//!Ordered map, the default. Memory is spent only on the items, which are
+//!visited in index order. Best for scarcely populated matrices.
+template<typename T>
+class matrix_2d_sparse {
+
+	public:
+
+	void				prepare(std::size_t) {}
+
+	T *					find(unsigned int _index) {
+
+		auto it=data.find(_index);
+		return it==std::end(data) ? nullptr : &it->second;
+	}
+
+	const T *			find(unsigned int _index) const {
+
+		auto it=data.find(_index);
+		return it==std::end(data) ? nullptr : &it->second;
+	}
+
+	template<typename ... Args>
+	std::pair<T *, bool>	try_emplace(unsigned int _index, Args&& ... _args) {
+
+		auto res=data.try_emplace(_index, std::forward<Args>(_args)...);
+		return {&res.first->second, res.second};
+	}
+
+	template<typename ... Args>
+	std::pair<T *, bool>	try_emplace_back(unsigned int _index, Args&& ... _args) {
+
+		const auto before=data.size();
+		auto it=data.try_emplace(std::end(data), _index, std::forward<Args>(_args)...);
+		return {&it->second, data.size()!=before};
+	}
+
+	bool				erase(unsigned int _index) {return data.erase(_index);}
+	std::size_t			size() const {return data.size();}
+	void				clear() {data.clear();}
 
+	template<typename F>
+	void				for_each_part(std::size_t _part, std::size_t _parts, std::size_t _cells, F&& _f) {
+
+		const auto first=static_cast<unsigned int>(_cells*_part/_parts);
+		const auto last=_cells*(_part+1)/_parts;
+		for(auto it=data.lower_bound(first); it!=std::end(data) && it->first < last; ++it) {
+			_f(it->first, it->second);
+		}
+	}
+
+	template<typename F>
+	void				for_each_part(std::size_t _part, std::size_t _parts, std::size_t _cells, F&& _f) const {
+
+		const auto first=static_cast<unsigned int>(_cells*_part/_parts);
+		const auto last=_cells*(_part+1)/_parts;
+		for(auto it=data.lower_bound(first); it!=std::end(data) && it->first < last; ++it) {
+			_f(it->first, it->second);
+		}
+	}
+
+	template<typename F>
+	void				relocate(std::size_t, F&& _to) {
+
+		//Nodes change their key and go to the end of the new map, so no
+		//item is moved or allocated again.
+		std::map<unsigned int, T>	moved;
+		while(!data.empty()) {
+
+			auto node=data.extract(std::begin(data));
+			unsigned int index=0;
+			if(_to(node.key(), index)) {
+				node.key()=index;
+				moved.insert(std::end(moved), std::move(node));
+			}
+		}
+
+		data.swap(moved);
+	}
+
+	template<typename F>
+	void				for_each(F&& _f) {
+
+		for(auto& p : data) {
+			_f(p.first, p.second);
+		}
+	}
+
+	template<typename F>
+	void				for_each(F&& _f) const {
+
+		for(const auto& p : data) {
+			_f(p.first, p.second);
+		}
+	}
+
+	//!Position of a region walk.
+	struct cursor {
+		unsigned int	x{0},	//!< X coordinate of the item.
+						y{0};	//!< Y coordinate of the item.
+		typename std::map<unsigned int, T>::const_iterator	it;	//!< Item.
+	};
+
+	const T *			next_in(cursor& _c, unsigned int _x0, unsigned int _y0, unsigned int _x1, unsigned int _y1, unsigned int _w, bool _after) const {
+
+		//Follows the map along each row, looking up only to jump over the
+		//cells outside the region.
+		auto it=_after ? std::next(_c.it) : data.lower_bound(_y0*_w+_x0);
+		while(it!=std::end(data)) {
+
+			const unsigned int ix=it->first % _w,
+								iy=it->first / _w;
+
+			if(iy >= _y1) {
+				return nullptr;
+			}
+
+			if(ix < _x0) {
+				it=data.lower_bound(iy*_w+_x0);
+			}
+			else if(ix >= _x1) {
+
+				if(iy+1 >= _y1) {
+					return nullptr;
+				}
+
+				it=data.lower_bound((iy+1)*_w+_x0);
+			}
+			else {
+				_c.x=ix;
+				_c.y=iy;
+				_c.it=it;
+				return &it->second;
+			}
+		}
+
+		return nullptr;
+	}
+
+	private:
+
+	std::map<unsigned int, T>	data;	//!< Items by index.
+};
+
+//!A std::optional per cell, in row order. Lookups are an index into a
+//!contiguous array and items are visited in index order, at the cost of
+//!memory for every cell. Best for mostly full matrices.
 template<typename T>
+class matrix_2d_dense {
+
+	public:
+
+	void				prepare(std::size_t _cells) {cells.resize(_cells);}
+
+	T *					find(unsigned int _index) {
+
+		auto& cell=cells[_index];
+		return cell ? &*cell : nullptr;
+	}
+
+	const T *			find(unsigned int _index) const {
+
+		const auto& cell=cells[_index];
+		return cell ? &*cell : nullptr;
+	}
+
+	template<typename ... Args>
+	std::pair<T *, bool>	try_emplace(unsigned int _index, Args&& ... _args) {
+
+		auto& cell=cells[_index];
+		if(cell) {
+			return {&*cell, false};
+		}
+
+		cell.emplace(std::forward<Args>(_args)...);
+		++count;
+		return {&*cell, true};
+	}
+
+	template<typename ... Args>
+	std::pair<T *, bool>	try_emplace_back(unsigned int _index, Args&& ... _args) {return try_emplace(_index, std::forward<Args>(_args)...);}
+
+	bool				erase(unsigned int _index) {
+
+		auto& cell=cells[_index];
+		if(!cell) {
+			return false;
+		}
+
+		cell.reset();
+		--count;
+		return true;
+	}
+
+	std::size_t			size() const {return count;}
+
+	void				clear() {
+
+		for(auto& cell : cells) {
+			cell.reset();
+		}
+		count=0;
+	}
+
+	template<typename F>
+	void				for_each_part(std::size_t _part, std::size_t _parts, std::size_t _cells, F&& _f) {
+
+		const std::size_t last=_cells*(_part+1)/_parts;
+		for(std::size_t i=_cells*_part/_parts; i<last; i++) {
+			if(cells[i]) {
+				_f(static_cast<unsigned int>(i), *cells[i]);
+			}
+		}
+	}
+
+	template<typename F>
+	void				for_each_part(std::size_t _part, std::size_t _parts, std::size_t _cells, F&& _f) const {
+
+		const std::size_t last=_cells*(_part+1)/_parts;
+		for(std::size_t i=_cells*_part/_parts; i<last; i++) {
+			if(cells[i]) {
+				_f(static_cast<unsigned int>(i), *cells[i]);
+			}
+		}
+	}
+
+	template<typename F>
+	void				relocate(std::size_t _cells, F&& _to) {
+
+		std::vector<std::optional<T>>	moved(_cells);
+		std::size_t						moved_count=0;
+		for(std::size_t i=0; i<cells.size(); i++) {
+
+			unsigned int index=0;
+			if(cells[i] && _to(static_cast<unsigned int>(i), index)) {
+				moved[index].emplace(std::move(*cells[i]));
+				++moved_count;
+			}
+		}
+
+		cells.swap(moved);
+		count=moved_count;
+	}
+
+	template<typename F>
+	void				for_each(F&& _f) {
+
+		for(std::size_t i=0; i<cells.size() && count; i++) {
+			if(cells[i]) {
+				_f(static_cast<unsigned int>(i), *cells[i]);
+			}
+		}
+	}
+
+	template<typename F>
+	void				for_each(F&& _f) const {
+
+		for(std::size_t i=0; i<cells.size() && count; i++) {
+			if(cells[i]) {
+				_f(static_cast<unsigned int>(i), *cells[i]);
+			}
+		}
+	}
+
+	//!Position of a region walk.
+	struct cursor {
+		unsigned int	x{0},	//!< X coordinate of the item.
+						y{0};	//!< Y coordinate of the item.
+	};
+
+	const T *			next_in(cursor& _c, unsigned int _x0, unsigned int _y0, unsigned int _x1, unsigned int _y1, unsigned int _w, bool _after) const {
+
+		unsigned int x=_x0, y=_y0;
+		if(_after) {
+
+			x=_c.x+1;
+			y=_c.y;
+			if(x >= _x1) {
+				x=_x0;
+				++y;
+			}
+		}
+
+		for(; y<_y1; ++y, x=_x0) {
+
+			const auto * row=cells.data()+static_cast<std::size_t>(y)*_w;
+			for(; x<_x1; ++x) {
+				if(row[x]) {
+					_c.x=x;
+					_c.y=y;
+					return &*row[x];
+				}
+			}
+		}
+
+		return nullptr;
+	}
+
+	private:
+
+	std::vector<std::optional<T>>	cells;		//!< One per cell.
+	std::size_t						count{0};	//!< Cells with an item.
+};
+
+//!Hash map. Memory is spent only on the items and lookups take constant
+//!time, but items are visited in no particular order. Best for sparse
+//!matrices that are read far more than they are iterated.
+template<typename T>
+class matrix_2d_hashed {
+
+	public:
+
+	void				prepare(std::size_t) {}
+
+	T *					find(unsigned int _index) {
+
+		auto it=data.find(_index);
+		return it==std::end(data) ? nullptr : &it->second;
+	}
+
+	const T *			find(unsigned int _index) const {
+
+		auto it=data.find(_index);
+		return it==std::end(data) ? nullptr : &it->second;
+	}
+
+	template<typename ... Args>
+	std::pair<T *, bool>	try_emplace(unsigned int _index, Args&& ... _args) {
+
+		auto res=data.try_emplace(_index, std::forward<Args>(_args)...);
+		return {&res.first->second, res.second};
+	}
+
+	template<typename ... Args>
+	std::pair<T *, bool>	try_emplace_back(unsigned int _index, Args&& ... _args) {return try_emplace(_index, std::forward<Args>(_args)...);}
+
+	bool				erase(unsigned int _index) {return data.erase(_index);}
+	std::size_t			size() const {return data.size();}
+	void				clear() {data.clear();}
+
+	template<typename F>
+	void				for_each_part(std::size_t _part, std::size_t _parts, std::size_t, F&& _f) {
+
+		const std::size_t buckets=data.bucket_count(),
+							last=buckets*(_part+1)/_parts;
+		for(std::size_t b=buckets*_part/_parts; b<last; b++) {
+			for(auto it=data.begin(b); it!=data.end(b); ++it) {
+				_f(it->first, it->second);
+			}
+		}
+	}
+
+	template<typename F>
+	void				for_each_part(std::size_t _part, std::size_t _parts, std::size_t, F&& _f) const {
+
+		const std::size_t buckets=data.bucket_count(),
+							last=buckets*(_part+1)/_parts;
+		for(std::size_t b=buckets*_part/_parts; b<last; b++) {
+			for(auto it=data.begin(b); it!=data.end(b); ++it) {
+				_f(it->first, it->second);
+			}
+		}
+	}
+
+	template<typename F>
+	void				relocate(std::size_t, F&& _to) {
+
+		//Nodes change their key and move to the new map, so no item is
+		//moved or allocated again.
+		std::unordered_map<unsigned int, T>	moved;
+		moved.reserve(data.size());
+		while(!data.empty()) {
+
+			auto node=data.extract(std::begin(data));
+			unsigned int index=0;
+			if(_to(node.key(), index)) {
+				node.key()=index;
+				moved.insert(std::move(node));
+			}
+		}
+
+		data.swap(moved);
+	}
+
+	template<typename F>
+	void				for_each(F&& _f) {
+
+		for(auto& p : data) {
+			_f(p.first, p.second);
+		}
+	}
+
+	template<typename F>
+	void				for_each(F&& _f) const {
+
+		for(const auto& p : data) {
+			_f(p.first, p.second);
+		}
+	}
+
+	//!Position of a region walk.
+	struct cursor {
+		unsigned int	x{0},	//!< X coordinate of the item.
+						y{0};	//!< Y coordinate of the item.
+	};
+
+	const T *			next_in(cursor& _c, unsigned int _x0, unsigned int _y0, unsigned int _x1, unsigned int _y1, unsigned int _w, bool _after) const {
+
+		unsigned int x=_x0, y=_y0;
+		if(_after) {
+
+			x=_c.x+1;
+			y=_c.y;
+			if(x >= _x1) {
+				x=_x0;
+				++y;
+			}
+		}
+
+		//Without order, small regions are probed cell by cell.
+		for(; y<_y1; ++y, x=_x0) {
+			for(; x<_x1; ++x) {
+
+				const T * item=find(y*_w+x);
+				if(nullptr!=item) {
+					_c.x=x;
+					_c.y=y;
+					return item;
+				}
+			}
+		}
+
+		return nullptr;
+	}
+
+	private:
+
+	std::unordered_map<unsigned int, T>	data;	//!< Items by index.
+};
+
+//!Implements a 2d matrix with fixed dimensions. Only positive indexes are
+//!allowed. How the items are kept is up to the storage policy: an ordered
+//!map by default, so storage is used only for the inserted items, or any of
+//!matrix_2d_dense and matrix_2d_hashed. The interface is the same for all.
+
+template<typename T, typename tstorage=matrix_2d_sparse<T>>
 class matrix_2d {
 
 	public:
 
+	//!Storage policy in use.
+	using storage=tstorage;
+
+	//!Read only range over a region or the neighbours of a cell, yielding
+	//!matrix_2d_cell<unsigned int, const T>.
+	using const_region_range=matrix_2d_region_range<const matrix_2d, unsigned int, const T>;
+	using const_neighbour_range=matrix_2d_neighbour_range<const matrix_2d, unsigned int, const T>;
+
+	//!Range over a region or the neighbours of a cell, yielding
+	//!matrix_2d_cell<unsigned int, T>.
+	using region_range=matrix_2d_region_range<matrix_2d, unsigned int, T>;
+	using neighbour_range=matrix_2d_neighbour_range<matrix_2d, unsigned int, T>;
+
 	//!Constructs a matrix with the given dimensions.
 					matrix_2d(unsigned int pw, unsigned int ph)
 		:w(pw), h(ph) {
 
+		data.prepare(static_cast<std::size_t>(w)*h);
+	}
+
+	//!Constructs a matrix with the given dimensions and the cells in the
+	//!range: matrix_2d_item<T> or anything with x, y and elem members, moved
+	//!from with move iterators. Cells sorted in row order are added in
+	//!linear time, others in the usual time. Will throw if a cell is out of
+	//!bounds or repeated.
+	template<typename It>
+					matrix_2d(unsigned int pw, unsigned int ph, It first, It last)
+		:matrix_2d(pw, ph) {
+
+		for(; first!=last; ++first) {
+			auto&& cell=*first;
+			if(!data.try_emplace_back(coords_to_index(cell.x, cell.y), std::forward<decltype(cell)>(cell).elem).second) {
+				throw matrix_2d_exception_conflict(cell.x, cell.y);
+			}
+		}
 	}
 
 	//!Copy-constructs a matrix,
@@ -94,64 +597,192 @@ class matrix_2d {
 
 	}
 
+	//!Move-constructs a matrix, leaving the other one empty and 0 x 0.
+					matrix_2d(matrix_2d&& o)
+		:data(std::move(o.data)), w(o.w), h(o.h) {
+
+		o.data.clear();
+		o.w=0;
+		o.h=0;
+	}
+
+	//!Copy assignment.
+	matrix_2d&			operator=(const matrix_2d&)=default;
+
+	//!Move assignment, leaving the other matrix empty and 0 x 0.
+	matrix_2d&			operator=(matrix_2d&& o) {
+
+		if(this!=&o) {
+			data=std::move(o.data);
+			w=o.w;
+			h=o.h;
+			o.data.clear();
+			o.w=0;
+			o.h=0;
+		}
+
+		return *this;
+	}
+
 	//!Inserts val into the x, y position. Might throw if already occupied.
-	void 				insert(unsigned int x, unsigned int y, T& val) {
-		unsigned int index=coords_to_index(x, y);
-		if(data.count(index)) throw matrix_2d_exception_conflict(x, y);
-		data.insert(std::make_pair(index, val));
+	void 				insert(unsigned int x, unsigned int y, const T& val) {
+		if(!data.try_emplace(coords_to_index(x, y), val).second) throw matrix_2d_exception_conflict(x, y);
 	}
 
 	//!Inserts val into the x, y position. Might throw if already occupied.
 	void 				insert(unsigned int x, unsigned int y, T&& val) {
-		unsigned int index=coords_to_index(x, y);
-		if(data.count(index)) throw matrix_2d_exception_conflict(x, y);
-		data.insert(std::make_pair(index, val));
+		if(!data.try_emplace(coords_to_index(x, y), std::move(val)).second) throw matrix_2d_exception_conflict(x, y);
 	}
 
 	//!Removes the element at x, y. Might throw if there's nothing there.
 	void 				erase(unsigned int x, unsigned int y) {
-		unsigned int index=coords_to_index(x, y);
-		if(!data.count(index)) throw matrix_2d_exception_missing(x, y);
-		data.erase(index);
+		if(!data.erase(coords_to_index(x, y))) throw matrix_2d_exception_missing(x, y);
 	}
 
-	//TODO: Provide a "replace" operator.
-	//TODO: Provide swap capabilities.
+	//!Builds an element in place at x, y from the arguments and returns it.
+	//!Will throw if the position is occupied or out of bounds.
+	template<typename ... Args>
+	T&				emplace(unsigned int x, unsigned int y, Args&& ... args) {
+		auto res=data.try_emplace(coords_to_index(x, y), std::forward<Args>(args)...);
+		if(!res.second) throw matrix_2d_exception_conflict(x, y);
+		return *res.first;
+	}
+
+	//!Builds an element in place at x, y from the arguments unless the
+	//!position is occupied, in which case the arguments are not touched.
+	//!Returns the element at x, y and whether it was built. Will throw only
+	//!if out of bounds.
+	template<typename ... Args>
+	std::pair<T&, bool>		try_emplace(unsigned int x, unsigned int y, Args&& ... args) {
+		auto res=data.try_emplace(coords_to_index(x, y), std::forward<Args>(args)...);
+		return {*res.first, res.second};
+	}
+
+	//!Inserts val at x, y or assigns it to the element already there.
+	//!Returns the element and true if it was inserted. Will throw only if
+	//!out of bounds.
+	template<typename V>
+	std::pair<T&, bool>		insert_or_assign(unsigned int x, unsigned int y, V&& val) {
+		//try_emplace leaves val untouched when the cell is taken.
+		auto res=data.try_emplace(coords_to_index(x, y), std::forward<V>(val));
+		if(!res.second) *res.first=std::forward<V>(val);
+		return {*res.first, res.second};
+	}
+
+	//!Replaces the element at x, y with val and returns it. Will throw if
+	//!there is nothing there.
+	T&				replace(unsigned int x, unsigned int y, const T& val) {
+		return (*this)(x, y)=val;
+	}
+
+	//!Replaces the element at x, y with val and returns it. Will throw if
+	//!there is nothing there.
+	T&				replace(unsigned int x, unsigned int y, T&& val) {
+		return (*this)(x, y)=std::move(val);
+	}
+
+	//!Exchanges the contents of the cells at x1, y1 and x2, y2, any of which
+	//!can be empty. Will throw if any is out of bounds.
+	void				swap(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2) {
+
+		const unsigned int a=coords_to_index(x1, y1),
+					b=coords_to_index(x2, y2);
+
+		if(a==b) return;
+
+		T * ia=data.find(a);
+		T * ib=data.find(b);
+
+		if(nullptr!=ia && nullptr!=ib) {
+			using std::swap;
+			swap(*ia, *ib);
+		}
+		else if(nullptr!=ia) {
+			data.try_emplace(b, std::move(*ia));
+			data.erase(a);
+		}
+		else if(nullptr!=ib) {
+			data.try_emplace(a, std::move(*ib));
+			data.erase(b);
+		}
+	}
+
+	//!Exchanges contents and dimensions with another matrix.
+	void				swap(matrix_2d& o) {
+		using std::swap;
+		swap(data, o.data);
+		swap(w, o.w);
+		swap(h, o.h);
+	}
 
 	//!Returns the element at x, y. Might throw. 
 	const T& 			operator()(unsigned int x, unsigned int y) const {
-		unsigned int index=coords_to_index(x, y);
-		if(!data.count(index)) throw matrix_2d_exception_missing(x, y);
-		return data.at(index);
+		const T * item=data.find(coords_to_index(x, y));
+		if(nullptr==item) throw matrix_2d_exception_missing(x, y);
+		return *item;
 	}
 
 	//!Returns the element at the given coordinates Throws if no item is present.
 	T& 				operator()(unsigned int x, unsigned int y) {
-		unsigned int index=coords_to_index(x, y);
-		if(!data.count(index)) throw matrix_2d_exception_missing(x, y);
-		return data.at(index);
+		T * item=data.find(coords_to_index(x, y));
+		if(nullptr==item) throw matrix_2d_exception_missing(x, y);
+		return *item;
 	}
 
 	//!Inserts val into x, y. Will throw if the position is occupied.
-	T& 				operator()(unsigned int x, unsigned int y, T& val) {
-		unsigned int index=coords_to_index(x, y);
-		if(data.count(index)) throw matrix_2d_exception_conflict(x, y);
-		data.insert(std::make_pair(index, val));
-		return data.at(index);
+	T& 				operator()(unsigned int x, unsigned int y, const T& val) {
+		auto res=data.try_emplace(coords_to_index(x, y), val);
+		if(!res.second) throw matrix_2d_exception_conflict(x, y);
+		return *res.first;
 	}
 
 	//!Inserts val into x, y. Will throw if the position is already occupied.
 	T& 				operator()(unsigned int x, unsigned int y, T&& val) {
-		unsigned int index=coords_to_index(x, y);
-		if(data.count(index)) throw matrix_2d_exception_conflict(x, y);
-		data.insert(std::make_pair(index, val));
-		return data.at(index);
+		auto res=data.try_emplace(coords_to_index(x, y), std::move(val));
+		if(!res.second) throw matrix_2d_exception_conflict(x, y);
+		return *res.first;
 	}
 
+	//!Returns a pointer to the element at x, y, nullptr if there is none or
+	//!the coordinates are out of bounds. Never throws.
+	const T *			find(unsigned int x, unsigned int y) const {
+		return x < w && y < h ? data.find((y * w) + x) : nullptr;
+	}
+
+	//!Returns a pointer to the element at x, y, nullptr if there is none or
+	//!the coordinates are out of bounds. Never throws.
+	T *				find(unsigned int x, unsigned int y) {
+		return x < w && y < h ? data.find((y * w) + x) : nullptr;
+	}
+
+	//!Returns the items in the pw x ph region whose top left corner is x, y,
+	//!row by row. The part outside the matrix is ignored.
+	const_region_range		region(unsigned int x, unsigned int y, unsigned int pw, unsigned int ph) const {
+		return {*this, std::min(x, w), std::min(y, h), clip(x, pw, w), clip(y, ph, h)};
+	}
+
+	//!Returns the items in the pw x ph region whose top left corner is x, y,
+	//!row by row. The part outside the matrix is ignored.
+	region_range			region(unsigned int x, unsigned int y, unsigned int pw, unsigned int ph) {
+		return {*this, std::min(x, w), std::min(y, h), clip(x, pw, w), clip(y, ph, h)};
+	}
+
+	//!Returns the items in the 4 cells that share a side with x, y.
+	const_neighbour_range		neighbours4(unsigned int x, unsigned int y) const {return {*this, x, y, 4};}
+
+	//!Returns the items in the 4 cells that share a side with x, y.
+	neighbour_range			neighbours4(unsigned int x, unsigned int y) {return {*this, x, y, 4};}
+
+	//!Returns the items in the 8 cells that touch x, y.
+	const_neighbour_range		neighbours8(unsigned int x, unsigned int y) const {return {*this, x, y, 8};}
+
+	//!Returns the items in the 8 cells that touch x, y.
+	neighbour_range			neighbours8(unsigned int x, unsigned int y) {return {*this, x, y, 8};}
+
 	//!Returns true if there is something in the given coordinates. Does
 	//!not do bound checking, so it might throw.
 	bool 				count(unsigned int x, unsigned int y) const {
-		return data.count(coords_to_index(x, y));
+		return nullptr!=data.find(coords_to_index(x, y));
 	}
 
 	//!Checks existence of a T in the given coordinates and returns true if
@@ -179,60 +810,137 @@ class matrix_2d {
 	unsigned int			get_h() const {return h;}
 	
 	//!Resizes the matrix to pw x ph. Items outside the range of the new
-	//!size (if smaller) are removed.
+	//!size (if smaller) are removed, the rest are moved to their new cells,
+	//!reusing the map nodes for the sparse and hashed storages.
 	void				resize(unsigned int pw, unsigned int ph) {
 
 		if(pw==w && ph==h) return;
 
-		//We need to remember the old values to perform index_to_coords.
-		unsigned int ow=w, oh=h;
+		//We need to remember the old width to perform index_to_coords.
+		unsigned int ow=w;
 
 		//Reassign...
 		w=pw;
 		h=ph;
 
-		//Save some cycles and data.
-		if(!data.size()) return;
-
-		//This is the real final container.
-		std::map<unsigned int, T> 	new_data;
-
-		//Iterate and reinsert those whitin range.
-		for(const auto& p : data) {
-			auto c=index_to_coords(p.first, ow, oh);
-			if(c.x < w && c.y < h) {
-				new_data.insert(std::make_pair(coords_to_index(c.x, c.y), p.second));
-			}
-		}
-
-		//Swap.
-		std::swap(new_data, data);
+		data.relocate(static_cast<std::size_t>(w)*h, [&](unsigned int _index, unsigned int& _to) {
+			auto c=index_to_coords(_index, ow);
+			if(c.x >= w || c.y >= h) return false;
+			_to=c.y*w+c.x;
+			return true;
+		});
 	}
 
 	//!Returns a new matrix from the current one, resized to pw x ph. 
 	//!Particularities of "resize" apply.
-	matrix_2d<T> 			copy_and_resize(unsigned int pw, unsigned int ph) const
+	matrix_2d 			copy_and_resize(unsigned int pw, unsigned int ph) const
 	{
-		matrix_2d<T> result(pw, ph);
+		matrix_2d result(pw, ph);
 
-		for(const auto& p : data) {
-			auto c=index_to_coords(p.first);
-			auto copia=p.second;
-			if(c.x < result.w && c.y < result.h) result(c.x, c.y, copia);
-		}
+		data.for_each([&](unsigned int _index, const T& _item) {
+			auto c=index_to_coords(_index, w);
+			if(c.x < result.w && c.y < result.h) result.data.try_emplace(c.y*result.w+c.x, _item);
+		});
 		return result;
 	}
 
 	//!Applies the function/functor f to every item in the matrix.
 	template <typename TipoFunc> 
 	void 				apply(TipoFunc& f) const {
-		for(auto& p : data) {
-			f(p.second);
+		data.for_each([&f](unsigned int, const T& _item) {
+			f(_item);
+		});
+	}
+
+	//!Applies the function/functor f to every item in the matrix along with
+	//!its coordinates, as f(x, y, item), in the order of the storage.
+	template <typename Tf>
+	void				apply_cells(Tf& f) const {
+		data.for_each([this, &f](unsigned int _index, const T& _item) {
+			f(_index % w, _index / w, _item);
+		});
+	}
+
+	//!Calls f(x, y, item) for every item, spread over the pool. The storage
+	//!is split in slices, by rows for the sparse and dense storages and by
+	//!hash buckets for matrix_2d_hashed, so f runs concurrently and may only
+	//!change the item it is given.
+	template <typename Tf>
+	void				parallel_apply(Tf&& f, worker_pool& pool=worker_pool::shared()) {
+		const std::size_t parts=parallel_parts();
+		pool.run(parts, [&](std::size_t _part) {
+			data.for_each_part(_part, parts, cells(), [&](unsigned int _index, T& _item) {
+				f(_index % w, _index / w, _item);
+			});
+		});
+	}
+
+	//!Calls f(x, y, item) for every item, spread over the pool, as the
+	//!non-const version does.
+	template <typename Tf>
+	void				parallel_apply(Tf&& f, worker_pool& pool=worker_pool::shared()) const {
+		const std::size_t parts=parallel_parts();
+		pool.run(parts, [&](std::size_t _part) {
+			data.for_each_part(_part, parts, cells(), [&](unsigned int _index, const T& _item) {
+				f(_index % w, _index / w, _item);
+			});
+		});
+	}
+
+	//!Fills out, resized to the dimensions of this matrix and cleared, with
+	//!the result of f(x, y, item) for every item, as in double buffered
+	//!simulations. f runs as in parallel_apply and the results are stored
+	//!on the calling thread. out must be another matrix.
+	template <typename Tf>
+	void				parallel_transform(matrix_2d& out, Tf&& f, worker_pool& pool=worker_pool::shared()) const {
+
+		const std::size_t parts=parallel_parts();
+		std::vector<std::vector<std::pair<unsigned int, T>>> results(parts);
+		pool.run(parts, [&](std::size_t _part) {
+			auto& result=results[_part];
+			data.for_each_part(_part, parts, cells(), [&](unsigned int _index, const T& _item) {
+				result.emplace_back(_index, f(_index % w, _index / w, _item));
+			});
+		});
+
+		out.clear();
+		out.resize(w, h);
+		for(auto& result : results) {
+			for(auto& p : result) {
+				out.data.try_emplace(p.first, std::move(p.second));
+			}
 		}
 	}
 
+	//!Returns init folded with combine(accumulated, map(x, y, item)) over
+	//!every item, spread over the pool. Each slice of the storage is folded
+	//!in order and the slices are folded in order too, and since the slices
+	//!depend on the matrix alone, the result is the same for any amount of
+	//!threads, even for floating point sums.
+	template <typename R, typename Tm, typename Tc>
+	R				parallel_reduce(R init, Tm&& map, Tc&& combine, worker_pool& pool=worker_pool::shared()) const {
+
+		const std::size_t parts=parallel_parts();
+		std::vector<std::optional<R>> partial(parts);
+		pool.run(parts, [&](std::size_t _part) {
+			auto& acc=partial[_part];
+			data.for_each_part(_part, parts, cells(), [&](unsigned int _index, const T& _item) {
+				if(acc) *acc=combine(std::move(*acc), map(_index % w, _index / w, _item));
+				else acc.emplace(map(_index % w, _index / w, _item));
+			});
+		});
+
+		for(auto& p : partial) {
+			if(p) init=combine(std::move(init), std::move(*p));
+		}
+
+		return init;
+	}
+
 	private:
 
+	template<typename, typename, typename> friend class matrix_2d_region_range;
+
 	//!Defines a pair of coordinates.
 	struct coords {
 		unsigned int 		x,	//!< Coordinate x.
@@ -240,32 +948,62 @@ class matrix_2d {
 		coords(unsigned int px, unsigned int py): x(px), y(py) {} //!< Class constructor.
 	};
 
-	std::map<unsigned int, T> 	data;	//!< Internal storage.
+	//!Returns the cell count.
+	std::size_t			cells() const {return static_cast<std::size_t>(w)*h;}
+
+	//!Returns how many slices the parallel functions split the storage in:
+	//!about one per parallel_grain items or cells, up to max_parallel_parts.
+	std::size_t			parallel_parts() const {
+		const std::size_t work=std::max(data.size(), cells()/8);
+		return std::min(max_parallel_parts, std::max<std::size_t>(1, work/parallel_grain));
+	}
+
+	static constexpr std::size_t	parallel_grain=1024;		//!< Items per slice.
+	static constexpr std::size_t	max_parallel_parts=256;		//!< Most slices.
+
+	//!Returns the end of a span that starts at p and is s long, within a
+	//!dimension of size d.
+	static unsigned int		clip(unsigned int p, unsigned int s, unsigned int d) {
+		return static_cast<unsigned int>(std::min<unsigned long long>(static_cast<unsigned long long>(p)+s, d));
+	}
+
+	//!Position of the region ranges in the storage.
+	using cursor=typename tstorage::cursor;
+
+	//!Moves the cursor to the next item of the region, for the region ranges.
+	const T *			next_in_region(cursor& c, unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1, bool after) const {
+		return data.next_in(c, x0, y0, x1, y1, w, after);
+	}
+
+	//!Moves the cursor to the next item of the region, for the region ranges.
+	T *				next_in_region(cursor& c, unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1, bool after) {
+		return const_cast<T *>(static_cast<const matrix_2d&>(*this).next_in_region(c, x0, y0, x1, y1, after));
+	}
+
+	tstorage		 	data;	//!< Internal storage.
 
 	unsigned int 			w, 	//!< Matrix width.
 					h;	//!< Matrix height.
 
 	private:
 
-	//!Converts the coordinates to a map index.
+	//!Converts the coordinates to a storage index.
 	unsigned int 			coords_to_index(unsigned int x, unsigned int y) const {
 		if(x >= w || y >= h) throw matrix_2d_exception_bounds(x, y);
 		return (y * w) + x;
 	}
 
-	//Converts a map index to coordinates.
-	coords 				index_to_coords(unsigned int index) const {
-		int y=index / w;
-		int x=index % w;
-		return coords(x, y);
-	}
-
-	//!Converts a map index to coordinates, considering pw and ph as width and height of the matrix.
-	coords 				index_to_coords(unsigned int index, unsigned int pw, unsigned int ph) const {
-		int y=index / ph;
-		int x=index % pw;
-		return coords(x, y);
+	//!Converts a storage index to coordinates, considering pw the width of
+	//!the matrix.
+	coords 				index_to_coords(unsigned int index, unsigned int pw) const {
+		return coords(index % pw, index / pw);
 	}
 };
 
+//!Exchanges the contents and dimensions of two matrices.
+template<typename T, typename tstorage>
+void					swap(matrix_2d<T, tstorage>& a, matrix_2d<T, tstorage>& b) {
+	a.swap(b);
+}
+
 }
@@ -0,0 +1,524 @@
+#pragma once
+
+#include "matrix_2d.h"
+#include "matrix_2d_unbound.h"
+#include "file_utils.h"
+
+#include <istream>
+#include <ostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <type_traits>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+
+//Binary files for matrix_2d and matrix_2d_unbound of trivially copyable
+//items. A file is a 64 byte matrix_2d_file_header, the index of the occupied
+//cells and, at header.data_offset, the items packed in the order of the
+//index. The index is a bitmap with a bit per cell, or the list of occupied
+//cells when that is smaller. matrix_2d cells go in row order, with the
+//bitmap covering the matrix and the list holding y * w + x as 32 bits.
+//matrix_2d_unbound cells go in column order, x first, as the default
+//storage keeps them, with the bitmap covering the bounding box of the items
+//and the list holding x, y pairs of 32 bits. Everything is written in the
+//byte order of the machine, which the header records.
+
+namespace tools{
+
+//!Thrown when a matrix file cannot be read or written.
+struct matrix_2d_io_exception:
+	public std::runtime_error {
+	//!Class constructor.
+	matrix_2d_io_exception(const std::string& msg):
+		std::runtime_error("matrix_2d_io error: "+msg) {
+	}
+};
+
+//!First 64 bytes of a matrix file.
+struct matrix_2d_file_header {
+
+	//!Matrix types.
+	enum kinds : std::uint32_t {
+		fixed=0,	//!< matrix_2d.
+		unbound=1	//!< matrix_2d_unbound.
+	};
+
+	//!Ways to index the occupied cells.
+	enum layouts : std::uint32_t {
+		bitmap=0,	//!< A bit per cell.
+		list=1		//!< Coordinates of each item.
+	};
+
+	char			magic[4];		//!< "TMX2".
+	std::uint32_t	version,		//!< Format version, 1.
+					byte_order,		//!< 0x01020304 in the order of the writer.
+					kind,			//!< One of kinds.
+					layout,			//!< One of layouts.
+					element_size;	//!< sizeof(T).
+	std::int32_t	x,				//!< X of the first cell, 0 for matrix_2d.
+					y;				//!< Y of the first cell, 0 for matrix_2d.
+	std::uint32_t	w,				//!< Cells per row.
+					h;				//!< Cells per column.
+	std::uint64_t	count,			//!< Items.
+					data_offset,	//!< Offset of the items from the start of the file.
+					reserved;		//!< Zero.
+
+	//!Returns a header for a matrix of the given kind, item size, first
+	//!cell, dimensions and count, indexed by the smaller of the bitmap, if
+	//!allowed, and the list.
+	static matrix_2d_file_header	make(kinds, std::size_t, std::int32_t, std::int32_t, std::uint32_t, std::uint32_t, std::uint64_t, bool);
+
+	//!Throws matrix_2d_io_exception if the header is not one of the given
+	//!kind for items of the given size, or is not sound.
+	void			check(kinds, std::size_t) const;
+
+	//!Returns the cells covered by the bitmap.
+	std::uint64_t	cells() const {return static_cast<std::uint64_t>(w)*h;}
+
+	//!Returns the size of the index, in bytes.
+	std::uint64_t	index_size() const;
+};
+
+static_assert(sizeof(matrix_2d_file_header)==64, "matrix_2d_file_header must take 64 bytes");
+
+//!Returns, for each word of a bitmap, the amount of bits set in the words
+//!before it.
+std::vector<std::uint64_t>	matrix_2d_file_ranks(const std::uint64_t *, std::size_t);
+
+//!Throws matrix_2d_io_exception if the cell list of the header is not
+//!sorted or has cells out of bounds.
+void			check_matrix_2d_file_list(const matrix_2d_file_header&, const std::uint32_t *);
+
+//!Writes a header, an index and the padding up to the items.
+void			write_matrix_2d_header(std::ostream&, const matrix_2d_file_header&, const std::vector<std::uint64_t>&, const std::vector<std::uint32_t>&);
+
+//!Reads and checks a header, reads and checks the index into one of the
+//!vectors and skips the padding up to the items. Throws
+//!matrix_2d_io_exception if any of it is wrong or the stream ends first.
+matrix_2d_file_header	read_matrix_2d_header(std::istream&, matrix_2d_file_header::kinds, std::size_t, std::vector<std::uint64_t>&, std::vector<std::uint32_t>&);
+
+//!Reads count items of the given size, throwing if the stream ends first.
+void			read_matrix_2d_items(std::istream&, char *, std::size_t, std::uint64_t);
+
+//!Packs items into blocks before writing them, instead of one stream call
+//!per item.
+class matrix_2d_item_writer {
+
+	public:
+
+	//!Writes to the given stream.
+	explicit			matrix_2d_item_writer(std::ostream&);
+
+	//!Adds the bytes of an item.
+	void				add(const void * _item, std::size_t _size) {
+
+		if(used+_size > block.size()) {
+			flush();
+			if(_size > block.size()) {
+				block.resize(_size);
+			}
+		}
+
+		std::memcpy(block.data()+used, _item, _size);
+		used+=_size;
+	}
+
+	//!Writes the items added so far. Throws matrix_2d_io_exception if the
+	//!stream fails.
+	void				flush();
+
+	private:
+
+	std::ostream&		out;		//!< Stream.
+	std::vector<char>	block;		//!< Items not yet written.
+	std::size_t			used{0};	//!< Bytes in the block.
+};
+
+//!Writes the matrix. Items are written straight from the storage if it
+//!keeps them in row order, as matrix_2d_sparse and matrix_2d_dense do, or
+//!through a sorted copy of pointers to them. Throws matrix_2d_io_exception
+//!if the stream fails.
+template<typename T, typename S>
+void			write_matrix(std::ostream& _out, const matrix_2d<T, S>& _matrix) {
+
+	static_assert(std::is_trivially_copyable<T>::value, "only matrices of trivially copyable items can be written");
+
+	const unsigned int w=_matrix.get_w();
+	const auto header=matrix_2d_file_header::make(matrix_2d_file_header::fixed, sizeof(T), 0, 0, w, _matrix.get_h(), _matrix.size(), true);
+
+	std::vector<std::uint64_t> words;
+	std::vector<std::uint32_t> list;
+	if(header.layout==matrix_2d_file_header::bitmap) {
+		words.resize((header.cells()+63)/64);
+	}
+	else {
+		list.reserve(header.count);
+	}
+
+	bool sorted=true;
+	std::uint32_t next=0;
+	auto index=[&](unsigned int _x, unsigned int _y, const T&) {
+
+		const std::uint32_t cell=_y*w+_x;
+		sorted=sorted && cell >= next;
+		next=cell+1;
+
+		if(header.layout==matrix_2d_file_header::bitmap) {
+			words[cell/64]|=std::uint64_t{1} << (cell%64);
+		}
+		else {
+			list.push_back(cell);
+		}
+	};
+	_matrix.apply_cells(index);
+
+	matrix_2d_item_writer out{_out};
+	if(sorted) {
+		write_matrix_2d_header(_out, header, words, list);
+		auto put=[&out](unsigned int, unsigned int, const T& _item) {out.add(&_item, sizeof(T));};
+		_matrix.apply_cells(put);
+		out.flush();
+		return;
+	}
+
+	std::vector<std::pair<std::uint32_t, const T *>> items;
+	items.reserve(header.count);
+	auto collect=[&items, w](unsigned int _x, unsigned int _y, const T& _item) {
+		items.push_back({_y*w+_x, &_item});
+	};
+	_matrix.apply_cells(collect);
+
+	std::sort(std::begin(items), std::end(items), [](const std::pair<std::uint32_t, const T *>& _a, const std::pair<std::uint32_t, const T *>& _b) {
+		return _a.first < _b.first;
+	});
+
+	std::sort(std::begin(list), std::end(list));
+	write_matrix_2d_header(_out, header, words, list);
+	for(const auto& item : items) {
+		out.add(item.second, sizeof(T));
+	}
+	out.flush();
+}
+
+
+//!Writes the matrix. Items are written straight from the storage if it
+//!keeps them in column order, as matrix_2d_unbound_ordered does, or through
+//!a sorted copy of pointers to them. Throws matrix_2d_io_exception if the
+//!stream fails.
+template<typename T, typename S>
+void			write_matrix(std::ostream& _out, const matrix_2d_unbound<T, S>& _matrix) {
+
+	static_assert(std::is_trivially_copyable<T>::value, "only matrices of trivially copyable items can be written");
+
+	using coords=matrix_2d_unbound_coords;
+	using item=std::pair<coords, const T *>;
+
+	//Finds the box of the items and whether they come in order.
+	bool sorted=true, empty=true;
+	coords last{}, low{}, high{};
+	auto bounds=[&](int _x, int _y, const T&) {
+
+		const coords current{_x, _y};
+		if(empty) {
+			low=high=current;
+			empty=false;
+		}
+		else {
+			sorted=sorted && last < current;
+			low={std::min(low.x, _x), std::min(low.y, _y)};
+			high={std::max(high.x, _x), std::max(high.y, _y)};
+		}
+
+		last=current;
+	};
+	_matrix.apply_cells(bounds);
+
+	//A side of the box may not fit 32 bits, then the list it is.
+	const std::uint64_t box_w=empty ? 0 : static_cast<std::int64_t>(high.x)-low.x+1,
+						box_h=empty ? 0 : static_cast<std::int64_t>(high.y)-low.y+1;
+	const bool fits=box_w <= UINT32_MAX && box_h <= UINT32_MAX;
+
+	const auto header=matrix_2d_file_header::make(
+		matrix_2d_file_header::unbound, sizeof(T), low.x, low.y,
+		fits ? static_cast<std::uint32_t>(box_w) : 0,
+		fits ? static_cast<std::uint32_t>(box_h) : 0,
+		_matrix.size(), fits);
+
+	std::vector<item> items;
+	if(!sorted) {
+		items.reserve(header.count);
+		auto collect=[&items](int _x, int _y, const T& _item) {items.push_back({{_x, _y}, &_item});};
+		_matrix.apply_cells(collect);
+		std::sort(std::begin(items), std::end(items), [](const item& _a, const item& _b) {return _a.first < _b.first;});
+	}
+
+	std::vector<std::uint64_t> words;
+	std::vector<std::uint32_t> list;
+	if(header.layout==matrix_2d_file_header::bitmap) {
+		words.resize((header.cells()+63)/64);
+	}
+	else {
+		list.reserve(2*header.count);
+	}
+
+	auto index=[&](int _x, int _y, const T&) {
+
+		if(header.layout==matrix_2d_file_header::bitmap) {
+			const std::uint64_t bit=static_cast<std::uint64_t>(static_cast<std::int64_t>(_x)-low.x)*box_h+static_cast<std::uint64_t>(static_cast<std::int64_t>(_y)-low.y);
+			words[bit/64]|=std::uint64_t{1} << (bit%64);
+		}
+		else {
+			list.push_back(static_cast<std::uint32_t>(_x));
+			list.push_back(static_cast<std::uint32_t>(_y));
+		}
+	};
+
+	matrix_2d_item_writer out{_out};
+	if(sorted) {
+		_matrix.apply_cells(index);
+		write_matrix_2d_header(_out, header, words, list);
+		auto put=[&out](int, int, const T& _item) {out.add(&_item, sizeof(T));};
+		_matrix.apply_cells(put);
+	}
+	else {
+		for(const auto& it : items) {
+			index(it.first.x, it.first.y, *it.second);
+		}
+
+		write_matrix_2d_header(_out, header, words, list);
+		for(const auto& it : items) {
+			out.add(it.second, sizeof(T));
+		}
+	}
+
+	out.flush();
+}
+
+//!Reads a matrix written by write_matrix into the given storage, adding the
+//!items in order so it takes linear time. Throws matrix_2d_io_exception if
+//!the file is not a matrix_2d of T or is damaged.
+template<typename T, typename S=matrix_2d_sparse<T>>
+matrix_2d<T, S>	read_matrix_2d(std::istream& _in) {
+
+	static_assert(std::is_trivially_copyable<T>::value, "only matrices of trivially copyable items can be read");
+
+	std::vector<std::uint64_t> words;
+	std::vector<std::uint32_t> list;
+	const auto header=read_matrix_2d_header(_in, matrix_2d_file_header::fixed, sizeof(T), words, list);
+
+	std::vector<T> values(header.count);
+	read_matrix_2d_items(_in, reinterpret_cast<char *>(values.data()), sizeof(T), header.count);
+
+	std::vector<matrix_2d_item<T>> cells;
+	cells.reserve(header.count);
+	auto add=[&](std::uint64_t _index) {
+		cells.emplace_back(static_cast<unsigned int>(_index % header.w), static_cast<unsigned int>(_index / header.w), values[cells.size()]);
+	};
+
+	if(header.layout==matrix_2d_file_header::bitmap) {
+		for(std::size_t w=0; w<words.size(); w++) {
+			for(auto bits=words[w]; bits; bits&=bits-1) {
+				add(w*64+matrix_2d_lowest_bit(bits));
+			}
+		}
+	}
+	else {
+		for(const auto index : list) {
+			add(index);
+		}
+	}
+
+	return matrix_2d<T, S>(header.w, header.h, std::make_move_iterator(std::begin(cells)), std::make_move_iterator(std::end(cells)));
+}
+
+//!Reads a matrix written by write_matrix into the given storage, adding the
+//!items in order so it takes linear time for the default storage. Throws
+//!matrix_2d_io_exception if the file is not a matrix_2d_unbound of T or is
+//!damaged.
+template<typename T, typename S=matrix_2d_unbound_ordered<T>>
+matrix_2d_unbound<T, S>	read_matrix_2d_unbound(std::istream& _in) {
+
+	static_assert(std::is_trivially_copyable<T>::value, "only matrices of trivially copyable items can be read");
+
+	std::vector<std::uint64_t> words;
+	std::vector<std::uint32_t> list;
+	const auto header=read_matrix_2d_header(_in, matrix_2d_file_header::unbound, sizeof(T), words, list);
+
+	std::vector<T> values(header.count);
+	read_matrix_2d_items(_in, reinterpret_cast<char *>(values.data()), sizeof(T), header.count);
+
+	using tpair=typename matrix_2d_unbound<T, S>::tpair;
+	std::vector<tpair> items;
+	items.reserve(header.count);
+
+	if(header.layout==matrix_2d_file_header::bitmap) {
+		for(std::size_t w=0; w<words.size(); w++) {
+			for(auto bits=words[w]; bits; bits&=bits-1) {
+				const std::uint64_t bit=w*64+matrix_2d_lowest_bit(bits);
+				items.push_back({{
+					static_cast<int>(header.x+static_cast<std::int64_t>(bit/header.h)),
+					static_cast<int>(header.y+static_cast<std::int64_t>(bit%header.h))
+				}, values[items.size()]});
+			}
+		}
+	}
+	else {
+		for(std::size_t i=0; i<list.size(); i+=2) {
+			items.push_back({{static_cast<int>(list[i]), static_cast<int>(list[i+1])}, values[items.size()]});
+		}
+	}
+
+	return matrix_2d_unbound<T, S>(std::begin(items), std::end(items));
+}
+
+//!Read only matrix_2d served straight from a mapped file written by
+//!write_matrix, with no copies: lookups find the item through the index,
+//!counting the bits before it in the bitmap or searching the list. Meant
+//!for large, mostly full grids that are loaded often and changed seldom.
+template<typename T>
+class matrix_2d_file_view {
+
+	static_assert(std::is_trivially_copyable<T>::value, "only matrices of trivially copyable items can be mapped");
+	static_assert(alignof(T) <= 64, "items are aligned to 64 bytes in the file");
+
+	public:
+
+	//!Maps the file. Throws matrix_2d_io_exception if it cannot be opened,
+	//!is not a matrix_2d of T or is damaged.
+	explicit			matrix_2d_file_view(const std::string& _path) {
+
+		if(!file.open(_path)) {
+			throw matrix_2d_io_exception("could not open "+_path);
+		}
+
+		const auto contents=file.data();
+		if(contents.size() < sizeof(matrix_2d_file_header)) {
+			throw matrix_2d_io_exception(_path+" is too short");
+		}
+
+		std::memcpy(&header, contents.data(), sizeof(header));
+		header.check(matrix_2d_file_header::fixed, sizeof(T));
+
+		if(contents.size() < header.data_offset+header.count*sizeof(T)) {
+			throw matrix_2d_io_exception(_path+" is truncated");
+		}
+
+		//The index and the items are aligned to 64 bytes from the start.
+		if(reinterpret_cast<std::uintptr_t>(contents.data()) % std::max(alignof(T), alignof(std::uint64_t))) {
+			throw matrix_2d_io_exception(_path+" is not mapped at an aligned address");
+		}
+
+		const char * index=contents.data()+sizeof(matrix_2d_file_header);
+		if(header.layout==matrix_2d_file_header::bitmap) {
+			bitmap=reinterpret_cast<const std::uint64_t *>(index);
+			ranks=matrix_2d_file_ranks(bitmap, (header.cells()+63)/64);
+			const auto tail=header.cells() % 64;
+			if(ranks.back()!=header.count || (tail && (bitmap[ranks.size()-2] >> tail))) {
+				throw matrix_2d_io_exception(_path+" has a bitmap that does not match the item count");
+			}
+		}
+		else {
+			list=reinterpret_cast<const std::uint32_t *>(index);
+			check_matrix_2d_file_list(header, list);
+		}
+
+		items=reinterpret_cast<const T *>(contents.data()+header.data_offset);
+	}
+
+	//!Returns the width of the matrix.
+	unsigned int		get_w() const {return header.w;}
+
+	//!Returns the height of the matrix.
+	unsigned int		get_h() const {return header.h;}
+
+	//!Returns the count of items.
+	std::size_t			size() const {return header.count;}
+
+	//!Returns a pointer to the element at x, y, nullptr if there is none or
+	//!the coordinates are out of bounds.
+	const T *			find(unsigned int x, unsigned int y) const {
+
+		if(x >= header.w || y >= header.h) {
+			return nullptr;
+		}
+
+		const std::uint64_t index=static_cast<std::uint64_t>(y)*header.w+x;
+		if(nullptr!=bitmap) {
+
+			const std::uint64_t word=bitmap[index/64],
+								bit=std::uint64_t{1} << (index%64);
+			if(!(word & bit)) {
+				return nullptr;
+			}
+
+			return items+ranks[index/64]+matrix_2d_popcount(word & (bit-1));
+		}
+
+		const auto end=list+header.count;
+		const auto it=std::lower_bound(list, end, static_cast<std::uint32_t>(index));
+		return it!=end && *it==index ? items+(it-list) : nullptr;
+	}
+
+	//!Checks if there is an item at x, y. Out of bounds cells are empty.
+	bool				check(unsigned int x, unsigned int y) const {return nullptr!=find(x, y);}
+
+	//!Returns the element at x, y. Throws if out of bounds or empty.
+	const T&			operator()(unsigned int x, unsigned int y) const {
+
+		if(x >= header.w || y >= header.h) throw matrix_2d_exception_bounds(x, y);
+		const T * item=find(x, y);
+		if(nullptr==item) throw matrix_2d_exception_missing(x, y);
+		return *item;
+	}
+
+	//!Calls f(x, y, item) for every item, in row order.
+	template<typename Tf>
+	void				apply_cells(Tf& f) const {
+
+		std::uint64_t item=0;
+		auto call=[&](std::uint64_t _index) {
+			f(static_cast<unsigned int>(_index % header.w), static_cast<unsigned int>(_index / header.w), items[item++]);
+		};
+
+		if(nullptr!=bitmap) {
+			for(std::size_t w=0; w<ranks.size()-1; w++) {
+				for(auto bits=bitmap[w]; bits; bits&=bits-1) {
+					call(w*64+matrix_2d_lowest_bit(bits));
+				}
+			}
+		}
+		else {
+			for(std::uint64_t i=0; i<header.count; i++) {
+				call(list[i]);
+			}
+		}
+	}
+
+	//!Returns a matrix with the given storage holding every item, added in
+	//!order in linear time.
+	template<typename S=matrix_2d_sparse<T>>
+	matrix_2d<T, S>		to_matrix() const {
+
+		std::vector<matrix_2d_item<T>> cells;
+		cells.reserve(header.count);
+		auto add=[&cells](unsigned int _x, unsigned int _y, const T& _item) {
+			cells.emplace_back(_x, _y, _item);
+		};
+		apply_cells(add);
+
+		return matrix_2d<T, S>(header.w, header.h, std::begin(cells), std::end(cells));
+	}
+
+	private:
+
+	mapped_file			file;				//!< Mapped contents.
+	matrix_2d_file_header	header;			//!< Copy of the header.
+	const std::uint64_t *	bitmap{nullptr};	//!< Bitmap, if that is the layout.
+	const std::uint32_t *	list{nullptr};		//!< Cell list, if that is the layout.
+	const T *			items{nullptr};		//!< Packed items.
+	std::vector<std::uint64_t>	ranks;		//!< Set bits before each bitmap word, and the total.
+};
+
+}
@@ -0,0 +1,201 @@
+#pragma once
+#include <iterator>
+#include <limits>
+#include <cstddef>
+
+namespace tools{
+
+//!A cell visited by the matrix ranges: its coordinates and its item.
+template<typename S, typename T>
+struct matrix_2d_cell {
+	S 			x, 		//!< X coordinate.
+				y;		//!< Y coordinate.
+	T& 			value;		//!< Stored element.
+};
+
+//!Items inside a rectangle of a matrix, for matrix_2d and matrix_2d_unbound.
+
+//!M is the matrix type, const for read only ranges, S its coordinate type
+//!and T the type of the items as seen through the range. The matrix walks
+//!its storage from one item to the next through next_in_region, keeping its
+//!position in a cursor of the storage, so the order is that of the storage
+//!and empty cells cost little or nothing. Changing the matrix invalidates
+//!the range and its iterators.
+template<typename M, typename S, typename T>
+class matrix_2d_region_range {
+
+	public:
+
+	//!Forward iterator over the items of the region.
+	class iterator {
+
+		public:
+
+		using iterator_category=std::forward_iterator_tag;
+		using value_type=matrix_2d_cell<S, T>;
+		using difference_type=std::ptrdiff_t;
+		using pointer=void;
+		using reference=matrix_2d_cell<S, T>;
+
+							iterator()=default;
+
+		//!Places the iterator on the first item of the range.
+		explicit			iterator(const matrix_2d_region_range& _range)
+			:range(&_range) {
+
+			item=range->matrix->next_in_region(position, range->x0, range->y0, range->x1, range->y1, false);
+		}
+
+		reference			operator*() const {return {position.x, position.y, *item};}
+
+		iterator&			operator++() {
+
+			item=range->matrix->next_in_region(position, range->x0, range->y0, range->x1, range->y1, true);
+			return *this;
+		}
+
+		iterator			operator++(int) {
+
+			auto copy=*this;
+			++(*this);
+			return copy;
+		}
+
+		bool				operator==(const iterator& _o) const {return item==_o.item;}
+		bool				operator!=(const iterator& _o) const {return item!=_o.item;}
+
+		private:
+
+		const matrix_2d_region_range *	range{nullptr};	//!< Range being walked.
+		typename M::cursor	position{};	//!< Position in the storage, with the coordinates of the item.
+		T *					item{nullptr};	//!< Current item, nullptr at the end.
+	};
+
+	//!Creates a range over the items with x0 <= x < x1 and y0 <= y < y1.
+						matrix_2d_region_range(M& _matrix, S _x0, S _y0, S _x1, S _y1)
+		:matrix(&_matrix), x0(_x0), y0(_y0), x1(_x1), y1(_y1) {
+
+	}
+
+	iterator			begin() const {return x0 < x1 && y0 < y1 ? iterator{*this} : iterator{};}
+	iterator			end() const {return iterator{};}
+
+	private:
+
+	M *					matrix;		//!< Matrix.
+	S					x0,			//!< First column.
+						y0,			//!< First row.
+						x1,			//!< Column past the last.
+						y1;			//!< Row past the last.
+};
+
+//!Occupied neighbours of a cell, for matrix_2d and matrix_2d_unbound.
+
+//!Visits the 4 orthogonal neighbours (up, right, down, left) and, for 8
+//!neighbours, the diagonals after them (up right, down right, down left, up
+//!left). Cells outside the matrix or the coordinate type are skipped, as
+//!are empty ones.
+template<typename M, typename S, typename T>
+class matrix_2d_neighbour_range {
+
+	public:
+
+	//!Forward iterator over the occupied neighbours.
+	class iterator {
+
+		public:
+
+		using iterator_category=std::forward_iterator_tag;
+		using value_type=matrix_2d_cell<S, T>;
+		using difference_type=std::ptrdiff_t;
+		using pointer=void;
+		using reference=matrix_2d_cell<S, T>;
+
+							iterator()=default;
+
+		//!Places the iterator on the first occupied neighbour.
+		explicit			iterator(const matrix_2d_neighbour_range& _range)
+			:range(&_range), index(0) {
+
+			seek();
+		}
+
+		reference			operator*() const {return {x, y, *item};}
+
+		iterator&			operator++() {
+
+			++index;
+			seek();
+			return *this;
+		}
+
+		iterator			operator++(int) {
+
+			auto copy=*this;
+			++(*this);
+			return copy;
+		}
+
+		bool				operator==(const iterator& _o) const {return item==_o.item;}
+		bool				operator!=(const iterator& _o) const {return item!=_o.item;}
+
+		private:
+
+		//!Moves to the first occupied neighbour from the current index on.
+		void				seek() {
+
+			static const int	dx[8]={0, 1, 0, -1, 1, 1, -1, -1},
+								dy[8]={-1, 0, 1, 0, -1, 1, 1, -1};
+
+			for(; index<range->count; index++) {
+
+				const long long nx=static_cast<long long>(range->x)+dx[index],
+								ny=static_cast<long long>(range->y)+dy[index];
+
+				if(!fits(nx) || !fits(ny)) {
+					continue;
+				}
+
+				x=static_cast<S>(nx);
+				y=static_cast<S>(ny);
+				item=range->matrix->find(x, y);
+				if(nullptr!=item) {
+					return;
+				}
+			}
+
+			item=nullptr;
+		}
+
+		//!Returns true if the value can be held by the coordinate type.
+		static bool			fits(long long _v) {
+
+			return _v >= static_cast<long long>(std::numeric_limits<S>::min())
+				&& _v <= static_cast<long long>(std::numeric_limits<S>::max());
+		}
+
+		const matrix_2d_neighbour_range *	range{nullptr};	//!< Range being walked.
+		std::size_t			index{0};	//!< Neighbour being looked at.
+		S					x{},		//!< X coordinate of the item.
+							y{};		//!< Y coordinate of the item.
+		T *					item{nullptr};	//!< Current item, nullptr at the end.
+	};
+
+	//!Creates a range over the 4 or 8 neighbours of x, y.
+						matrix_2d_neighbour_range(M& _matrix, S _x, S _y, std::size_t _count)
+		:matrix(&_matrix), x(_x), y(_y), count(_count) {
+
+	}
+
+	iterator			begin() const {return iterator{*this};}
+	iterator			end() const {return iterator{};}
+
+	private:
+
+	M *					matrix;		//!< Matrix.
+	S					x,			//!< X coordinate of the center.
+						y;			//!< Y coordinate of the center.
+	std::size_t			count;		//!< 4 or 8.
+};
+
+}
@@ -1,6 +1,19 @@
 #pragma once
 #include "compatibility_patches.h"
+#include "matrix_2d_ranges.h"
+#include "worker_pool.h"
 #include <map>
+#include <unordered_map>
+#include <memory>
+#include <array>
+#include <new>
+#include <utility>
+#include <vector>
+#include <optional>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <type_traits>
 #include <stdexcept>
 #include <string>
 
@@ -42,36 +55,752 @@ struct matrix_2d_unbound_exception_conflict:
 		) {}
 };
 
-//!2d matrix representing a cell set with no fixed size bounds.
+//!Coordinate pair of a matrix_2d_unbound, ordered first on the x axis.
+struct matrix_2d_unbound_coords {
+	int x, 	//!< X coordinate.
+		y;	//!< Y coordinate.
+
+	//!Comparison operator, ordered first on the x axis, lesser to greater.
+	bool operator<(const matrix_2d_unbound_coords& o) const
+	{
+		if(x < o.x) return true;
+		else if(x > o.x) return false;
+		else return y < o.y;
+	}
+};
 
-//!Both positive and negative coordinates can be used with it.
+//!Storage policies for matrix_2d_unbound. Each one keeps the items by their
+//!coordinates and provides:
+//!	find(x, y): pointer to the item, nullptr if the cell is empty.
+//!	try_emplace(x, y, args...): builds the item in place only if the cell is
+//!		empty. Returns a pointer to the item in the cell and true if it was
+//!		built.
+//!	try_emplace_back(x, y, args...): the same, in constant time when the
+//!		coordinates come after those of every item in the order of the
+//!		storage, if it has one.
+//!	erase(x, y): removes the item, returns false if there was none.
+//!	size(), clear().
+//!	for_each(f): calls f(x, y, item) for every item.
+//!	for_each_in(x0, y0, x1, y1, f): calls f(x, y, item) for every item with
+//!		x0 <= x < x1 and y0 <= y < y1.
+//!	for_each_part(part, parts, f): calls f(x, y, item) for the items of one
+//!		of parts disjoint slices of the storage, by column range or by hash
+//!		bucket of chunks. Const and non-const.
+//!	next_in(cursor, x0, y0, x1, y1, after): moves the cursor to the first
+//!		item of that region, or to the one after it if asked, in the order
+//!		of for_each_in. Returns the item, nullptr if none is left. The
+//!		cursor type holds the x and y of the item and whatever else makes
+//!		the next step cheap.
 
+//!Ordered map, the default. Items are visited column by column, x first.
 template<typename T>
-class matrix_2d_unbound {
+class matrix_2d_unbound_ordered {
 
 	public:
 
-	typedef int 			tscalar;	//!< Typedef to the type used for the coordinates.
+	using coords=matrix_2d_unbound_coords;
 
-	//!Structure reprenting a coordinate pair, ordered first on the x axis.
-	struct coords{
-		tscalar x, 	//!< X coordinate.
-			y;	//!< Y coordinate.
+	T *					find(int _x, int _y) {
+
+		auto it=data.find({_x, _y});
+		return it==std::end(data) ? nullptr : &it->second;
+	}
+
+	const T *			find(int _x, int _y) const {
+
+		auto it=data.find({_x, _y});
+		return it==std::end(data) ? nullptr : &it->second;
+	}
+
+	template<typename ... Args>
+	std::pair<T *, bool>	try_emplace(int _x, int _y, Args&& ... _args) {
+
+		auto res=data.try_emplace(coords{_x, _y}, std::forward<Args>(_args)...);
+		return {&res.first->second, res.second};
+	}
+
+	template<typename ... Args>
+	std::pair<T *, bool>	try_emplace_back(int _x, int _y, Args&& ... _args) {
+
+		const auto before=data.size();
+		auto it=data.try_emplace(std::end(data), coords{_x, _y}, std::forward<Args>(_args)...);
+		return {&it->second, data.size()!=before};
+	}
+
+	bool				erase(int _x, int _y) {return data.erase({_x, _y});}
+	std::size_t			size() const {return data.size();}
+	void				clear() {data.clear();}
+
+	template<typename F>
+	void				for_each(F&& _f) const {
+
+		for(const auto& p : data) {
+			_f(p.first.x, p.first.y, p.second);
+		}
+	}
+
+	template<typename F>
+	void				for_each_in(int _x0, int _y0, int _x1, int _y1, F&& _f) const {
+
+		if(_x0 >= _x1 || _y0 >= _y1) {
+			return;
+		}
+
+		//Walks each column from its first row in range, jumping to the next
+		//column past the last one.
+		auto it=data.lower_bound({_x0, _y0});
+		while(it!=std::end(data) && it->first.x < _x1) {
+
+			if(it->first.y < _y0) {
+				it=data.lower_bound({it->first.x, _y0});
+			}
+			else if(it->first.y >= _y1) {
+
+				if(it->first.x==_x1-1) {
+					break;
+				}
+
+				it=data.lower_bound({it->first.x+1, _y0});
+			}
+			else {
+				_f(it->first.x, it->first.y, it->second);
+				++it;
+			}
+		}
+	}
+
+	template<typename F>
+	void				for_each_part(std::size_t _part, std::size_t _parts, F&& _f) {part_of(data, _part, _parts, _f);}
+
+	template<typename F>
+	void				for_each_part(std::size_t _part, std::size_t _parts, F&& _f) const {part_of(data, _part, _parts, _f);}
+
+	//!Position of a region walk.
+	struct cursor {
+		int			x{0},	//!< X coordinate of the item.
+					y{0};	//!< Y coordinate of the item.
+		typename std::map<coords, T>::const_iterator	it;	//!< Item.
+	};
+
+	const T *			next_in(cursor& _c, int _x0, int _y0, int _x1, int _y1, bool _after) const {
+
+		//Column by column, as in for_each_in.
+		auto it=_after ? std::next(_c.it) : data.lower_bound({_x0, _y0});
+		while(it!=std::end(data) && it->first.x < _x1) {
+
+			if(it->first.y < _y0) {
+				it=data.lower_bound({it->first.x, _y0});
+			}
+			else if(it->first.y >= _y1) {
+
+				if(it->first.x==_x1-1) {
+					break;
+				}
+
+				it=data.lower_bound({it->first.x+1, _y0});
+			}
+			else {
+				_c.x=it->first.x;
+				_c.y=it->first.y;
+				_c.it=it;
+				return &it->second;
+			}
+		}
+
+		return nullptr;
+	}
+
+	//!Gives access to the map, for apply_pair.
+	const std::map<coords, T>&	get_map() const {return data;}
+
+	private:
+
+	//!Calls f for the items of one of parts column slices of the map, const
+	//!or not.
+	template<typename M, typename F>
+	static void			part_of(M& _data, std::size_t _part, std::size_t _parts, F& _f) {
+
+		if(_data.empty()) {
+			return;
+		}
+
+		//Columns between the first and the last are split evenly.
+		const long long lo=std::begin(_data)->first.x,
+						span=std::prev(std::end(_data))->first.x-lo+1,
+						x0=lo+span*static_cast<long long>(_part)/static_cast<long long>(_parts),
+						x1=lo+span*static_cast<long long>(_part+1)/static_cast<long long>(_parts);
+
+		if(x0==x1) {
+			return;
+		}
+
+		for(auto it=_data.lower_bound({static_cast<int>(x0), std::numeric_limits<int>::min()}); it!=std::end(_data) && it->first.x < x1; ++it) {
+			_f(it->first.x, it->first.y, it->second);
+		}
+	}
+
+	std::map<coords, T>	data;	//!< Items by coordinates.
+};
+
+//!Returns the position of the lowest set bit of a non zero value, for the
+//!occupancy bitmaps of the matrices.
+inline unsigned int		matrix_2d_lowest_bit(std::uint64_t _value) {
+
+#if defined(__GNUC__)
+	return static_cast<unsigned int>(__builtin_ctzll(_value));
+#else
+	unsigned int result=0;
+	while(!(_value & 1)) {
+		_value>>=1;
+		++result;
+	}
+	return result;
+#endif
+}
+
+//!Returns the amount of set bits of a value.
+inline unsigned int		matrix_2d_popcount(std::uint64_t _value) {
+
+#if defined(__GNUC__)
+	return static_cast<unsigned int>(__builtin_popcountll(_value));
+#else
+	_value=_value-((_value >> 1) & 0x5555555555555555ull);
+	_value=(_value & 0x3333333333333333ull)+((_value >> 2) & 0x3333333333333333ull);
+	_value=(_value+(_value >> 4)) & 0x0f0f0f0f0f0f0f0full;
+	return static_cast<unsigned int>((_value*0x0101010101010101ull) >> 56);
+#endif
+}
+
+//!Square chunks of 2^chunk_bits cells per side, 32 x 32 by default, kept in
+//!a hash map by chunk coordinate. Each chunk is an array of cells with an
+//!occupancy bitmask and is released when it becomes empty. Neighbouring
+//!cells share memory, so row scans and region queries touch few chunks.
+//!Items are visited chunk by chunk in no particular order, row by row
+//!within each chunk.
+template<typename T, unsigned int chunk_bits=5>
+class matrix_2d_unbound_chunked {
+
+	struct chunk;
+
+	public:
+
+	//!Cells per side of a chunk.
+	static constexpr int			chunk_side=1 << chunk_bits;
+
+	//!Cells in a chunk.
+	static constexpr std::size_t	chunk_cells=static_cast<std::size_t>(chunk_side)*chunk_side;
+
+	static_assert(chunk_bits >= 3 && chunk_bits <= 8, "chunks must be between 8 and 256 cells per side");
+
+							matrix_2d_unbound_chunked()=default;
+
+	//!Leaves the other storage empty, with a size of zero.
+							matrix_2d_unbound_chunked(matrix_2d_unbound_chunked&& _o) noexcept
+		:chunks(std::move(_o.chunks)),
+		total(std::exchange(_o.total, 0)) {
+
+		_o.chunks.clear();
+	}
+
+	//!Leaves the other storage empty, with a size of zero.
+	matrix_2d_unbound_chunked&	operator=(matrix_2d_unbound_chunked&& _o) noexcept {
+
+		if(this!=&_o) {
+			chunks=std::move(_o.chunks);
+			_o.chunks.clear();
+			total=std::exchange(_o.total, 0);
+		}
+
+		return *this;
+	}
+
+							matrix_2d_unbound_chunked(const matrix_2d_unbound_chunked& _o)
+		:total(_o.total) {
+
+		for(const auto& p : _o.chunks) {
+			chunks.emplace(p.first, std::make_unique<chunk>(*p.second));
+		}
+	}
+
+	matrix_2d_unbound_chunked&	operator=(const matrix_2d_unbound_chunked& _o) {
+
+		if(this!=&_o) {
+			matrix_2d_unbound_chunked copy(_o);
+			std::swap(*this, copy);
+		}
+
+		return *this;
+	}
+
+	T *					find(int _x, int _y) {
+
+		chunk * c=find_chunk(_x, _y);
+		const auto cell=cell_index(_x, _y);
+		return nullptr!=c && c->is_set(cell) ? c->at(cell) : nullptr;
+	}
+
+	const T *			find(int _x, int _y) const {
+
+		const chunk * c=find_chunk(_x, _y);
+		const auto cell=cell_index(_x, _y);
+		return nullptr!=c && c->is_set(cell) ? c->at(cell) : nullptr;
+	}
+
+	template<typename ... Args>
+	std::pair<T *, bool>	try_emplace(int _x, int _y, Args&& ... _args) {
+
+		const auto key=chunk_key(_x, _y);
+		const auto cell=cell_index(_x, _y);
+		auto it=chunks.find(key);
+		if(it!=std::end(chunks)) {
+
+			if(it->second->is_set(cell)) {
+				return {it->second->at(cell), false};
+			}
+
+			T * item=it->second->emplace(cell, std::forward<Args>(_args)...);
+			++total;
+			return {item, true};
+		}
+
+		//The chunk enters the map holding its item, so a throwing
+		//allocation or constructor leaves no empty or null chunk behind.
+		auto created=std::make_unique<chunk>();
+		T * item=created->emplace(cell, std::forward<Args>(_args)...);
+		chunks.emplace(key, std::move(created));
+		++total;
+		return {item, true};
+	}
+
+	template<typename ... Args>
+	std::pair<T *, bool>	try_emplace_back(int _x, int _y, Args&& ... _args) {return try_emplace(_x, _y, std::forward<Args>(_args)...);}
+
+	bool				erase(int _x, int _y) {
+
+		auto it=chunks.find(chunk_key(_x, _y));
+		const auto cell=cell_index(_x, _y);
+		if(it==std::end(chunks) || !it->second->is_set(cell)) {
+			return false;
+		}
+
+		it->second->destroy(cell);
+		--total;
+
+		if(!it->second->count) {
+			chunks.erase(it);
+		}
+
+		return true;
+	}
+
+	std::size_t			size() const {return total;}
+	void				clear() {chunks.clear(); total=0;}
+
+	//!Returns the amount of allocated chunks.
+	std::size_t			chunk_count() const {return chunks.size();}
+
+	template<typename F>
+	void				for_each(F&& _f) const {
+
+		for(const auto& p : chunks) {
+			visit(p.first, static_cast<const chunk&>(*p.second), 0, 0, chunk_side, chunk_side, _f);
+		}
+	}
+
+	template<typename F>
+	void				for_each_in(int _x0, int _y0, int _x1, int _y1, F&& _f) const {
+
+		if(_x0 >= _x1 || _y0 >= _y1) {
+			return;
+		}
+
+		const long long cx0=_x0 >> chunk_bits,
+						cy0=_y0 >> chunk_bits,
+						cx1=(_x1-1) >> chunk_bits,
+						cy1=(_y1-1) >> chunk_bits;
+
+		//Clips the region to a chunk and visits what is inside.
+		auto clipped=[&](std::uint64_t _key, const chunk& _c) {
+
+			const long long ox=static_cast<long long>(key_x(_key))*chunk_side,
+							oy=static_cast<long long>(key_y(_key))*chunk_side;
+
+			visit(_key, _c,
+				static_cast<int>(std::max<long long>(_x0-ox, 0)),
+				static_cast<int>(std::max<long long>(_y0-oy, 0)),
+				static_cast<int>(std::min<long long>(_x1-ox, chunk_side)),
+				static_cast<int>(std::min<long long>(_y1-oy, chunk_side)),
+				_f);
+		};
+
+		//Looking every chunk of the region up only pays when there are
+		//fewer of them than chunks allocated.
+		if(static_cast<unsigned long long>((cx1-cx0+1)*(cy1-cy0+1)) > chunks.size()) {
+
+			for(const auto& p : chunks) {
+
+				const long long cx=key_x(p.first), cy=key_y(p.first);
+				if(cx >= cx0 && cx <= cx1 && cy >= cy0 && cy <= cy1) {
+					clipped(p.first, *p.second);
+				}
+			}
+
+			return;
+		}
+
+		for(long long cy=cy0; cy<=cy1; cy++) {
+			for(long long cx=cx0; cx<=cx1; cx++) {
+
+				const auto key=make_key(static_cast<int>(cx), static_cast<int>(cy));
+				auto it=chunks.find(key);
+				if(it!=std::end(chunks)) {
+					clipped(key, *it->second);
+				}
+			}
+		}
+	}
+
+	template<typename F>
+	void				for_each_part(std::size_t _part, std::size_t _parts, F&& _f) {
+
+		const std::size_t buckets=chunks.bucket_count(),
+							last=buckets*(_part+1)/_parts;
+		for(std::size_t b=buckets*_part/_parts; b<last; b++) {
+			for(auto it=chunks.begin(b); it!=chunks.end(b); ++it) {
+				visit(it->first, *it->second, 0, 0, chunk_side, chunk_side, _f);
+			}
+		}
+	}
+
+	template<typename F>
+	void				for_each_part(std::size_t _part, std::size_t _parts, F&& _f) const {
+
+		const std::size_t buckets=chunks.bucket_count(),
+							last=buckets*(_part+1)/_parts;
+		for(std::size_t b=buckets*_part/_parts; b<last; b++) {
+			for(auto it=chunks.begin(b); it!=chunks.end(b); ++it) {
+				visit(it->first, static_cast<const chunk&>(*it->second), 0, 0, chunk_side, chunk_side, _f);
+			}
+		}
+	}
+
+	//!Position of a region walk.
+	struct cursor {
+		int			x{0},	//!< X coordinate of the item.
+					y{0};	//!< Y coordinate of the item.
+		typename std::unordered_map<std::uint64_t, std::unique_ptr<chunk>>::const_iterator	it;	//!< Chunk of the item.
+		std::size_t	word{0};	//!< Mask word of the item.
+		std::uint64_t	rest{0};	//!< Bits of the word after the item still in the region.
+	};
+
+	const T *			next_in(cursor& _c, int _x0, int _y0, int _x1, int _y1, bool _after) const {
+
+		using chunk_iterator=typename std::unordered_map<std::uint64_t, std::unique_ptr<chunk>>::const_iterator;
+
+		const long long cx0=_x0 >> chunk_bits,
+						cy0=_y0 >> chunk_bits,
+						cx1=(_x1-1) >> chunk_bits,
+						cy1=(_y1-1) >> chunk_bits;
+
+		//Returns the first item of the chunk in the region at or after the
+		//local cell, row by row, moving the cursor to it.
+		auto seek=[&](chunk_iterator _at, int _lx, int _ly) -> const T * {
+
+			const long long ox=static_cast<long long>(key_x(_at->first))*chunk_side,
+							oy=static_cast<long long>(key_y(_at->first))*chunk_side;
+			const int lx0=static_cast<int>(std::max<long long>(_x0-ox, 0)),
+						lx1=static_cast<int>(std::min<long long>(_x1-ox, chunk_side)),
+						ly1=static_cast<int>(std::min<long long>(_y1-oy, chunk_side));
+
+			for(int ly=_ly; ly<ly1; ly++, _lx=lx0) {
+
+				if(_lx >= lx1) {
+					continue;
+				}
+
+				const std::size_t row=static_cast<std::size_t>(ly) << chunk_bits;
+				for(std::size_t w=(row+_lx)/64; w<=(row+lx1-1)/64; w++) {
+
+					std::uint64_t bits=masked(*_at->second, w, row+_lx, row+lx1);
+					if(bits) {
+
+						const std::size_t cell=w*64+matrix_2d_lowest_bit(bits);
+						_c.x=static_cast<int>(ox+static_cast<long long>(cell-row));
+						_c.y=static_cast<int>(oy+ly);
+						_c.it=_at;
+						_c.word=w;
+						_c.rest=bits & (bits-1);
+						return _at->second->at(cell);
+					}
+				}
+			}
+
+			return nullptr;
+		};
+
+		//Returns the first item of the chunk in the region.
+		auto first=[&](chunk_iterator _at) -> const T * {
+
+			const long long ox=static_cast<long long>(key_x(_at->first))*chunk_side,
+							oy=static_cast<long long>(key_y(_at->first))*chunk_side;
+			return seek(_at, static_cast<int>(std::max<long long>(_x0-ox, 0)), static_cast<int>(std::max<long long>(_y0-oy, 0)));
+		};
+
+		//Chunks are walked as in for_each_in: by chunk coordinates when the
+		//region spans fewer chunks than are allocated, in map order if not.
+		const bool by_map=static_cast<unsigned long long>((cx1-cx0+1)*(cy1-cy0+1)) > chunks.size();
+		long long cx=cx0, cy=cy0;
+		auto it=std::begin(chunks);
+
+		if(_after) {
+
+			//The rest of the word holds the next items of the row.
+			if(_c.rest) {
+
+				const std::size_t cell=_c.word*64+matrix_2d_lowest_bit(_c.rest);
+				_c.rest&=_c.rest-1;
+				_c.x+=static_cast<int>(cell & (chunk_side-1))-(_c.x & (chunk_side-1));
+				return _c.it->second->at(cell);
+			}
+
+			const T * item=seek(_c.it, (_c.x & (chunk_side-1))+1, _c.y & (chunk_side-1));
+			if(nullptr!=item) {
+				return item;
+			}
+
+			it=std::next(_c.it);
+			cx=key_x(_c.it->first)+1LL;
+			cy=key_y(_c.it->first);
+		}
+
+		if(by_map) {
+
+			for(; it!=std::end(chunks); ++it) {
+
+				const long long kx=key_x(it->first), ky=key_y(it->first);
+				if(kx >= cx0 && kx <= cx1 && ky >= cy0 && ky <= cy1) {
+
+					const T * item=first(it);
+					if(nullptr!=item) {
+						return item;
+					}
+				}
+			}
+
+			return nullptr;
+		}
+
+		for(; cy<=cy1; cy++, cx=cx0) {
+			for(; cx<=cx1; cx++) {
+
+				auto found=chunks.find(make_key(static_cast<int>(cx), static_cast<int>(cy)));
+				if(found!=std::end(chunks)) {
+
+					const T * item=first(found);
+					if(nullptr!=item) {
+						return item;
+					}
+				}
+			}
+		}
+
+		return nullptr;
+	}
+
+	private:
+
+	//!A square of cells. Items are built in place in raw storage and the
+	//!bitmask tells which cells hold one.
+	struct chunk {
+
+		static constexpr std::size_t	words=chunk_cells/64;
+
+		//!Leaves the cells uninitialized, as only the mask tells which
+		//!hold an item.
+						chunk() {}
+
+						chunk(const chunk& _o) {
+
+			//The destructor does not run if a copy throws, so the items
+			//copied so far are destroyed here.
+			try {
+				for(std::size_t i=0; i<chunk_cells; i++) {
+					if(_o.is_set(i)) {
+						emplace(i, *_o.at(i));
+					}
+				}
+			}
+			catch(...) {
+				clear();
+				throw;
+			}
+		}
+
+		chunk&			operator=(const chunk&)=delete;
+
+						~chunk() {clear();}
 
-		//!Comparison operator, ordered first on the x axis, lesser to greater.
-		bool operator<(const coords& o) const
-		{
-			if(x < o.x) return true;
-			else if(x > o.x) return false;
-			else return y < o.y;
+		//!Destroys every item.
+		void			clear() {
+
+			for(std::size_t i=0; i<chunk_cells && count; i++) {
+				if(is_set(i)) {
+					destroy(i);
+				}
+			}
+		}
+
+		bool			is_set(std::size_t _cell) const {return occupied[_cell / 64] & (std::uint64_t{1} << (_cell % 64));}
+		T *				at(std::size_t _cell) {return std::launder(reinterpret_cast<T *>(raw)+_cell);}
+		const T *		at(std::size_t _cell) const {return std::launder(reinterpret_cast<const T *>(raw)+_cell);}
+
+		template<typename ... Args>
+		T *				emplace(std::size_t _cell, Args&& ... _args) {
+
+			T * item=::new(static_cast<void *>(reinterpret_cast<T *>(raw)+_cell)) T(std::forward<Args>(_args)...);
+			occupied[_cell / 64]|=std::uint64_t{1} << (_cell % 64);
+			++count;
+			return item;
 		}
+
+		void			destroy(std::size_t _cell) {
+
+			at(_cell)->~T();
+			occupied[_cell / 64]&=~(std::uint64_t{1} << (_cell % 64));
+			--count;
+		}
+
+		std::array<std::uint64_t, words>	occupied{};	//!< A bit per cell.
+		std::size_t							count{0};	//!< Cells with an item.
+		alignas(T) unsigned char			raw[sizeof(T)*chunk_cells];	//!< Cells, row by row.
 	};
 
+	static_assert(chunk_cells % 64==0, "chunks must fill whole mask words");
+
+	//!Packs chunk coordinates in a key.
+	static std::uint64_t	make_key(int _cx, int _cy) {return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(_cx)) << 32) | static_cast<std::uint32_t>(_cy);}
+
+	//!Returns the key of the chunk holding the cell. Shifting negative values
+	//!rounds down, so -1 falls in chunk -1.
+	static std::uint64_t	chunk_key(int _x, int _y) {return make_key(_x >> chunk_bits, _y >> chunk_bits);}
+
+	static int				key_x(std::uint64_t _key) {return static_cast<int>(static_cast<std::uint32_t>(_key >> 32));}
+	static int				key_y(std::uint64_t _key) {return static_cast<int>(static_cast<std::uint32_t>(_key));}
+
+	//!Returns the position of the cell within its chunk.
+	static std::size_t		cell_index(int _x, int _y) {return static_cast<std::size_t>(((_y & (chunk_side-1)) << chunk_bits) | (_x & (chunk_side-1)));}
+
+	chunk *					find_chunk(int _x, int _y) {
+
+		auto it=chunks.find(chunk_key(_x, _y));
+		return it==std::end(chunks) ? nullptr : it->second.get();
+	}
+
+	const chunk *			find_chunk(int _x, int _y) const {
+
+		auto it=chunks.find(chunk_key(_x, _y));
+		return it==std::end(chunks) ? nullptr : it->second.get();
+	}
+
+	//!Calls the function with the items of the chunk whose local coordinates
+	//!are in [lx0, lx1) and [ly0, ly1), using the mask to skip empty cells.
+	template<typename C, typename F>
+	static void				visit(std::uint64_t _key, C& _c, int _lx0, int _ly0, int _lx1, int _ly1, F& _f) {
+
+		if(_lx0 >= _lx1 || _ly0 >= _ly1) {
+			return;
+		}
+
+		const int ox=key_x(_key)*chunk_side,
+				oy=key_y(_key)*chunk_side;
+
+		for(int ly=_ly0; ly<_ly1; ly++) {
+
+			const std::size_t row=static_cast<std::size_t>(ly) << chunk_bits;
+			for(std::size_t w=(row+_lx0)/64; w<=(row+_lx1-1)/64; w++) {
+
+				std::uint64_t bits=masked(_c, w, row+_lx0, row+_lx1);
+				while(bits) {
+
+					const std::size_t cell=w*64+matrix_2d_lowest_bit(bits);
+					bits&=bits-1;
+					_f(ox+static_cast<int>(cell & (chunk_side-1)), oy+ly, *_c.at(cell));
+				}
+			}
+		}
+	}
+
+	//!Returns the bits of a mask word of the chunk for the cells in
+	//![first, last).
+	static std::uint64_t	masked(const chunk& _c, std::size_t _word, std::size_t _first, std::size_t _last) {
+
+		std::uint64_t bits=_c.occupied[_word];
+		const std::size_t begin=_word*64;
+		if(_first > begin) {
+			bits&=~std::uint64_t{0} << (_first-begin);
+		}
+		if(_last < begin+64) {
+			bits&=~(~std::uint64_t{0} << (_last-begin));
+		}
+
+		return bits;
+	}
+
+	std::unordered_map<std::uint64_t, std::unique_ptr<chunk>>	chunks;		//!< Chunks by packed chunk coordinates.
+	std::size_t													total{0};	//!< Items in all chunks.
+};
+
+//!2d matrix representing a cell set with no fixed size bounds.
+
+//!Both positive and negative coordinates can be used with it. How the items
+//!are kept is up to the storage policy: an ordered map by default, or
+//!matrix_2d_unbound_chunked for large, dense worlds. The interface is the
+//!same for all, though the order in which items are visited depends on the
+//!storage.
+
+template<typename T, typename tstorage=matrix_2d_unbound_ordered<T>>
+class matrix_2d_unbound {
+
+	public:
+
+	typedef int 			tscalar;	//!< Typedef to the type used for the coordinates.
+
+	//!Structure reprenting a coordinate pair, ordered first on the x axis.
+	typedef matrix_2d_unbound_coords	coords;
+
 	typedef std::pair<coords, T>	tpair;	//!< Typedef to map a pair of coordinates to a T type.
 
+	//!Storage policy in use.
+	using storage=tstorage;
+
+	//!Read only range over a region or the neighbours of a cell, yielding
+	//!matrix_2d_cell<int, const T>.
+	using const_region_range=matrix_2d_region_range<const matrix_2d_unbound, tscalar, const T>;
+	using const_neighbour_range=matrix_2d_neighbour_range<const matrix_2d_unbound, tscalar, const T>;
+
+	//!Range over a region or the neighbours of a cell, yielding
+	//!matrix_2d_cell<int, T>.
+	using region_range=matrix_2d_region_range<matrix_2d_unbound, tscalar, T>;
+	using neighbour_range=matrix_2d_neighbour_range<matrix_2d_unbound, tscalar, T>;
+
 	//!Default constructor.
 					matrix_2d_unbound() {}
 
+	//!Creates a matrix_2d_unbound with the items in the range of tpair, or
+	//!anything with first.x, first.y and second members, moved from with
+	//!move iterators. Items sorted by coordinates, x first, are added in
+	//!linear time to the default storage. Will throw if a cell is repeated.
+	template<typename It>
+					matrix_2d_unbound(It first, It last) {
+
+		for(; first!=last; ++first) {
+			auto&& item=*first;
+			if(!data.try_emplace_back(item.first.x, item.first.y, std::forward<decltype(item)>(item).second).second) {
+				throw matrix_2d_unbound_exception_conflict(item.first.x, item.first.y);
+			}
+		}
+	}
+
 	//!Creates a matrix_2d_unbound from another.
 					matrix_2d_unbound(const matrix_2d_unbound& o)
 		:data(o.data)
@@ -80,66 +809,91 @@ class matrix_2d_unbound {
 	}
 
 	//!Inserts the value in the coordinates. Will throw if there is a value present.
-	void 				insert(tscalar x, tscalar y, T& val)
+	void 				insert(tscalar x, tscalar y, const T& val)
 	{
-		auto index=make_index(x, y);
-		if(data.count(index)) throw matrix_2d_unbound_exception_conflict(x, y);
-		data.insert(std::make_pair(index, val));
+		if(!data.try_emplace(x, y, val).second) throw matrix_2d_unbound_exception_conflict(x, y);
 	}
 
 	//!Inserts the value in the coordinates. Will throw if there is a value present.
 	void 				insert(tscalar x, tscalar y, T&& val)
 	{
-		auto index=make_index(x, y);
-		if(data.count(index)) throw matrix_2d_unbound_exception_conflict(x, y);
-		data.insert(std::make_pair(index, val));
+		if(!data.try_emplace(x, y, std::move(val)).second) throw matrix_2d_unbound_exception_conflict(x, y);
 	}
 
 	//!Removes the value in the coordinates. Will throw if there is no value present.
 	void 				erase(tscalar x, tscalar y)
 	{
-		auto index=make_index(x, y);
-		if(!data.count(index)) throw matrix_2d_unbound_exception_missing(x, y);
-		data.erase(index);
+		if(!data.erase(x, y)) throw matrix_2d_unbound_exception_missing(x, y);
 	}
 
 	//!Gets the element at the given coordinates. Will throw if there is no value present.
 	const T& 			operator()(tscalar x, tscalar y) const
 	{
-		auto index=make_index(x, y);
-		if(!data.count(index)) throw matrix_2d_unbound_exception_missing(x, y);
-		return data.at(index);
+		const T * item=data.find(x, y);
+		if(nullptr==item) throw matrix_2d_unbound_exception_missing(x, y);
+		return *item;
 	}
 
 	//!Gets the element at the given coordinates. Will throw if there is no value present.
 	T& 				operator()(tscalar x, tscalar y)
 	{
-		auto index=make_index(x, y);
-		if(!data.count(index)) throw matrix_2d_unbound_exception_missing(x, y);
-		return data.at(index);
+		T * item=data.find(x, y);
+		if(nullptr==item) throw matrix_2d_unbound_exception_missing(x, y);
+		return *item;
 	}
 
 	//!Inserts the value at the given coordinates. Will throw is there is a value present.
-	T& 				operator()(tscalar x, tscalar y, T& val)
+	T& 				operator()(tscalar x, tscalar y, const T& val)
 	{
-		auto index=make_index(x, y);
-		if(data.count(index)) throw matrix_2d_unbound_exception_conflict(x, y);
-		data.insert(std::make_pair(index, val));
-		return data.at(index);
+		auto res=data.try_emplace(x, y, val);
+		if(!res.second) throw matrix_2d_unbound_exception_conflict(x, y);
+		return *res.first;
 	}
 
 	//!Inserts the value at the given coordinates. Will throw is there is a value present.
 	T& 				operator()(tscalar x, tscalar y, T&& val)
 	{
-		auto index=make_index(x, y);
-		if(data.count(index)) throw matrix_2d_unbound_exception_conflict(x, y);
-		data.insert(std::make_pair(index, val));
-		return data.at(index);
+		auto res=data.try_emplace(x, y, std::move(val));
+		if(!res.second) throw matrix_2d_unbound_exception_conflict(x, y);
+		return *res.first;
 	}
 
 
 	//!Checks if there is a value in the given coordinates.
-	bool 				check(tscalar x, tscalar y) const {return data.count(make_index(x, y));}
+	bool 				check(tscalar x, tscalar y) const {return nullptr!=data.find(x, y);}
+
+	//!Returns a pointer to the element at x, y, nullptr if there is none.
+	//!Never throws.
+	const T *			find(tscalar x, tscalar y) const {return data.find(x, y);}
+
+	//!Returns a pointer to the element at x, y, nullptr if there is none.
+	//!Never throws.
+	T *				find(tscalar x, tscalar y) {return data.find(x, y);}
+
+	//!Returns the items in the w x h region whose top left corner is x, y,
+	//!in the order of the storage: column by column for the default one,
+	//!chunk by chunk for matrix_2d_unbound_chunked, as apply_region does.
+	const_region_range		region(tscalar x, tscalar y, unsigned int w, unsigned int h) const {
+		return {*this, x, y, clip(x, w), clip(y, h)};
+	}
+
+	//!Returns the items in the w x h region whose top left corner is x, y,
+	//!in the order of the storage.
+	region_range			region(tscalar x, tscalar y, unsigned int w, unsigned int h) {
+		return {*this, x, y, clip(x, w), clip(y, h)};
+	}
+
+	//!Returns the items in the 4 cells that share a side with x, y.
+	const_neighbour_range		neighbours4(tscalar x, tscalar y) const {return {*this, x, y, 4};}
+
+	//!Returns the items in the 4 cells that share a side with x, y.
+	neighbour_range			neighbours4(tscalar x, tscalar y) {return {*this, x, y, 4};}
+
+	//!Returns the items in the 8 cells that touch x, y.
+	const_neighbour_range		neighbours8(tscalar x, tscalar y) const {return {*this, x, y, 8};}
+
+	//!Returns the items in the 8 cells that touch x, y.
+	neighbour_range			neighbours8(tscalar x, tscalar y) {return {*this, x, y, 8};}
 
 	//!Returns the total amount of values in the matrix.
 	size_t 				size() 	const {return data.size();}
@@ -150,21 +904,144 @@ class matrix_2d_unbound {
 	//!Executes the function or functor for each value in the matrix.
 	template <typename Tf> 
 	void 				apply(Tf& f) const {
-		for(const auto& p : data) f(p.second);
+		data.for_each([&f](tscalar, tscalar, const T& _item) {f(_item);});
 	}
 	
 	//!Executes the function or functor for each pair (std::pair<coords, T>) in the matrix, giving access to the coordinates object.
+	//!Storages other than the default build each pair on the fly, copying the
+	//!value: apply_region gives the coordinates without copies.
 	template <typename Tf> 
 	void 				apply_pair(Tf& f) const {
-		for(const auto& p : data) f(p);
+		if constexpr(std::is_same<tstorage, matrix_2d_unbound_ordered<T>>::value) {
+			for(const auto& p : data.get_map()) f(p);
+		}
+		else {
+			data.for_each([&f](tscalar _x, tscalar _y, const T& _item) {
+				const tpair p{coords{_x, _y}, _item};
+				f(p);
+			});
+		}
+	}
+
+	//!Applies the function/functor f to every item in the matrix along with
+	//!its coordinates, as f(x, y, item), in the order of the storage.
+	template <typename Tf>
+	void				apply_cells(Tf& f) const {
+		data.for_each(f);
+	}
+
+	//!Executes the function or functor with the coordinates and the value of
+	//!every item in the w x h region whose top left corner is x, y, as
+	//!f(x, y, value). Only the part of the storage covering the region is
+	//!visited.
+	template <typename Tf>
+	void				apply_region(tscalar x, tscalar y, unsigned int w, unsigned int h, Tf& f) const {
+
+		data.for_each_in(x, y, clip(x, w), clip(y, h), f);
+	}
+
+	//!Calls f(x, y, item) for every item, spread over the pool. The storage
+	//!is split in slices, by columns for the default storage and by chunks
+	//!for matrix_2d_unbound_chunked, so f runs concurrently and may only
+	//!change the item it is given.
+	template <typename Tf>
+	void				parallel_apply(Tf&& f, worker_pool& pool=worker_pool::shared()) {
+		const std::size_t parts=parallel_parts();
+		pool.run(parts, [&](std::size_t _part) {
+			data.for_each_part(_part, parts, f);
+		});
+	}
+
+	//!Calls f(x, y, item) for every item, spread over the pool, as the
+	//!non-const version does.
+	template <typename Tf>
+	void				parallel_apply(Tf&& f, worker_pool& pool=worker_pool::shared()) const {
+		const std::size_t parts=parallel_parts();
+		pool.run(parts, [&](std::size_t _part) {
+			data.for_each_part(_part, parts, f);
+		});
+	}
+
+	//!Fills out, cleared first, with the result of f(x, y, item) for every
+	//!item. f runs as in parallel_apply and the results are stored on the
+	//!calling thread. out must be another matrix.
+	template <typename Tf>
+	void				parallel_transform(matrix_2d_unbound& out, Tf&& f, worker_pool& pool=worker_pool::shared()) const {
+
+		const std::size_t parts=parallel_parts();
+		std::vector<std::vector<std::pair<coords, T>>> results(parts);
+		pool.run(parts, [&](std::size_t _part) {
+			auto& result=results[_part];
+			data.for_each_part(_part, parts, [&](tscalar _x, tscalar _y, const T& _item) {
+				result.emplace_back(coords{_x, _y}, f(_x, _y, _item));
+			});
+		});
+
+		out.clear();
+		for(auto& result : results) {
+			for(auto& p : result) {
+				out.data.try_emplace(p.first.x, p.first.y, std::move(p.second));
+			}
+		}
+	}
+
+	//!Returns init folded with combine(accumulated, map(x, y, item)) over
+	//!every item, spread over the pool. Slices are folded in order, each in
+	//!storage order, and depend on the matrix alone, so the result is the
+	//!same for any amount of threads.
+	template <typename R, typename Tm, typename Tc>
+	R				parallel_reduce(R init, Tm&& map, Tc&& combine, worker_pool& pool=worker_pool::shared()) const {
+
+		const std::size_t parts=parallel_parts();
+		std::vector<std::optional<R>> partial(parts);
+		pool.run(parts, [&](std::size_t _part) {
+			auto& acc=partial[_part];
+			data.for_each_part(_part, parts, [&](tscalar _x, tscalar _y, const T& _item) {
+				if(acc) *acc=combine(std::move(*acc), map(_x, _y, _item));
+				else acc.emplace(map(_x, _y, _item));
+			});
+		});
+
+		for(auto& p : partial) {
+			if(p) init=combine(std::move(init), std::move(*p));
+		}
+
+		return init;
 	}
 
 	private:
 
-	std::map<coords, T> 	data;	//!< Internal representation of the stored data.
+	template<typename, typename, typename> friend class matrix_2d_region_range;
+
+	//!Returns how many slices the parallel functions split the storage in:
+	//!about one per parallel_grain items, up to max_parallel_parts.
+	std::size_t			parallel_parts() const {
+		return std::min(max_parallel_parts, std::max<std::size_t>(1, data.size()/parallel_grain));
+	}
+
+	static constexpr std::size_t	parallel_grain=1024;		//!< Items per slice.
+	static constexpr std::size_t	max_parallel_parts=256;		//!< Most slices.
+
+	//!Returns the end of a span that starts at p and is s long. The last
+	//!value of the coordinates cannot be reached.
+	static tscalar			clip(tscalar p, unsigned int s) {
+		return static_cast<tscalar>(std::min<long long>(static_cast<long long>(p)+s, std::numeric_limits<tscalar>::max()));
+	}
+
+	//!Position of the region ranges in the storage.
+	using cursor=typename tstorage::cursor;
+
+	//!Moves the cursor to the next item of the region, for the region ranges.
+	const T *			next_in_region(cursor& c, tscalar x0, tscalar y0, tscalar x1, tscalar y1, bool after) const {
+		return data.next_in(c, x0, y0, x1, y1, after);
+	}
+
+	//!Moves the cursor to the next item of the region, for the region ranges.
+	T *				next_in_region(cursor& c, tscalar x0, tscalar y0, tscalar x1, tscalar y1, bool after) {
+		return const_cast<T *>(static_cast<const matrix_2d_unbound&>(*this).next_in_region(c, x0, y0, x1, y1, after));
+	}
 
-	//!Creates a coords object from two scalars.
-	coords				make_index(tscalar x, tscalar y) const {return {x, y};}
+	tstorage		 	data;	//!< Internal representation of the stored data.
 };
 
 }
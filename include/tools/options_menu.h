@@ -3,6 +3,7 @@
 #include "ranged_value.h"
 #include "json.h"
 #include "algorithm.h"
+#include "instrumentation.h"
 
 #include <rapidjson/document.h>
 
@@ -828,6 +829,7 @@ class options_menu {
 	//!Specifically returns integer values from an integer option.
 	int		get_int(const tkey& _key) const {
 
+		TOOLS_INSTRUMENT("options_menu::get_int");
 		assert_valid_key<tkey>();
 		const auto& o=get_entry(_key);
 
@@ -847,6 +849,7 @@ class options_menu {
 	//!Specifically returns double values from an integer option.
 	double		get_double(const tkey& _key) const {
 
+		TOOLS_INSTRUMENT("options_menu::get_double");
 		assert_valid_key<tkey>();
 		const auto& o=get_entry(_key);
 
@@ -866,6 +869,7 @@ class options_menu {
 	//!Specifically returns bool values from an bool option.
 	bool	get_bool(const tkey& _key) const {
 
+		TOOLS_INSTRUMENT("options_menu::get_bool");
 		assert_valid_key<tkey>();
 		const auto& o=get_entry(_key);
 		if(types::tbool != o->get_value_type()) {
@@ -883,6 +887,7 @@ class options_menu {
 	//!Specifically returns string values from a string option.
 	std::string	get_string(const tkey& _key) const {
 
+		TOOLS_INSTRUMENT("options_menu::get_string");
 		assert_valid_key<tkey>();
 		const auto& o=get_entry(_key);
 		if(types::tstring != o->get_value_type()) {
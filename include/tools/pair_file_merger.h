@@ -0,0 +1,99 @@
+#pragma once
+
+#include "pair_file_parser.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+namespace tools{
+
+//!Merges several pair files stacked in layers, such as defaults, user and
+//!platform overrides. Later layers override earlier ones. Each key is
+//!resolved once and remembers which layer set its value. Replacing a layer
+//!only revisits the keys of that layer.
+class pair_file_merger {
+
+	public:
+
+	//!Creates a merger with no layers.
+						pair_file_merger()=default;
+
+	//!The index views keys it owns, so copies are not allowed.
+						pair_file_merger(const pair_file_merger&)=delete;
+						pair_file_merger(pair_file_merger&&)=default;
+	pair_file_merger&			operator=(const pair_file_merger&)=delete;
+	pair_file_merger&			operator=(pair_file_merger&&)=default;
+
+	//!Adds a layer on top of the existing ones. Returns its index.
+	size_t					add_layer(const pair_file_parser&);
+
+	//!Replaces the data of an existing layer, such as after reloading its
+	//!file. Throws std::out_of_range if the layer does not exist.
+	void					replace_layer(size_t, const pair_file_parser&);
+
+	//!Returns true if the key exists in any layer.
+	bool					exists(std::string_view _key) const {return index.count(_key);}
+
+	//!Returns the amount of different keys.
+	size_t					size() const {return index.size();}
+
+	//!Returns the amount of layers.
+	size_t					layer_count() const {return layers.size();}
+
+	//!Returns the file name of the given layer. Throws std::out_of_range if
+	//!the layer does not exist.
+	const std::string&			get_layer_filename(size_t _layer) const {return layers.at(_layer).filename;}
+
+	//!Returns the winning value for the key. Throws std::out_of_range if the
+	//!key does not exist.
+	const std::string&			get(std::string_view) const;
+
+	//!Returns the index of the layer that set the winning value for the key.
+	//!Throws std::out_of_range if the key does not exist.
+	size_t					provenance(std::string_view) const;
+
+	//!Calls the callback with every key, its winning value and its layer.
+	template<typename F>
+	void					for_each(F&& _callback) const {
+
+		for(const auto& pair : index) {
+			const auto& winner=pair.second.values.back();
+			_callback(pair.first, std::string_view{winner.value}, winner.layer);
+		}
+	}
+
+	private:
+
+	//!A value given to a key by a layer.
+	struct layer_value {
+		size_t			layer;		//!< Layer that gives the value.
+		std::string		value;		//!< The value.
+	};
+
+	//!Everything given to a key. The key lives on the heap, where moving
+	//!the entry does not move it, so the index can view it.
+	struct key_values {
+		std::unique_ptr<const std::string>	key;		//!< The key.
+		std::vector<layer_value>			values;		//!< Values, sorted by layer.
+	};
+
+	//!What is known about each layer.
+	struct layer {
+		std::string						filename;	//!< Path of the file.
+		std::vector<std::string_view>	keys;		//!< Keys the layer gives a value to.
+	};
+
+	//!Stores the values of the file as the given layer.
+	void					apply(size_t, const pair_file_parser&);
+
+	//!Finds the values of the key, throwing if it does not exist.
+	const std::vector<layer_value>&	find(std::string_view) const;
+
+	std::vector<layer>		layers;		//!< Layers, lowest priority first.
+	std::unordered_map<std::string_view, key_values>	index;	//!< Values by key. Keys given by no layer are erased with their entry.
+};
+
+}
@@ -2,18 +2,23 @@
 
 #include "string_utils.h"
 
-#include <map>
+#include <deque>
+#include <unordered_map>
+#include <string_view>
 #include <exception>
 
 namespace tools{
 
 //!Wrapper for key-value based data, read from a file.
 
-//!Implemented in terms of the text_reader class, so supports comments. The
-//!format expects N lines consisting on a single pair of key and value separated
-//!by a delimiter character. Lines can also be empty or begin with a comment
-//!character. The delimiter and comment character are to be supplied by the 
-//!client code.
+//!Supports comments. The format expects N lines consisting on a single pair
+//!of key and value separated by a delimiter character. Lines can also be empty
+//!or begin with a comment character. The delimiter and comment character are
+//!to be supplied by the client code.
+
+//!Every line of the file is kept in order, so saving preserves comments,
+//!blank lines and the original text of unchanged pairs. Keys are looked up
+//!through a hash index that accepts string_views.
 
 class pair_file_parser
 {
@@ -23,33 +28,83 @@ class pair_file_parser
 	//!file cannot be found or has the wrong format.
 						pair_file_parser(const std::string&, char, char);
 
-	//!Saves the internal storage data to the file. Will not preserve the
-	//!original order of entries not comments or blank lines.
+						pair_file_parser(const pair_file_parser&);
+						pair_file_parser(pair_file_parser&&)=default;
+	pair_file_parser&			operator=(const pair_file_parser&);
+	pair_file_parser&			operator=(pair_file_parser&&)=default;
+
+	//!Saves the internal storage data to the file in a single buffered
+	//!write. Comments, blank lines and unchanged pairs are written as they
+	//!were read, changed values are rewritten in place and new keys are
+	//!appended. Does nothing if nothing changed since loading.
 	void					save();
 
-	//!Syncs this instance with the values of a second.
+	//!Syncs this instance with the values of a second, adding the keys that
+	//!are missing here in the order they appear there.
 	void					sync(const pair_file_parser& f);
 
-	//!Returns the configuration value with the given key. Throws with 
-	//!the corresponding std::map exception if the item cannot be found.
-	const std::string&			operator[](const std::string key) const {return data.at(key);}
+	//!Returns true if the key exists.
+	bool					exists(std::string_view _key) const {return index.count(_key);}
+
+	//!Returns the amount of keys.
+	size_t					size() const {return index.size();}
+
+	//!Returns the path of the file.
+	const std::string&			get_filename() const {return filename;}
+
+	//!Calls the callback with the key and value of every pair as
+	//!string_views, in file order. Repeated keys are only visited once, on
+	//!the line that holds their value.
+	template<typename F>
+	void					for_each_pair(F&& _callback) const {
+
+		for(size_t i=0; i<lines.size(); i++) {
 
+			const auto& l=lines[i];
+			if(l.pair && i==index.at(l.key)) {
+				_callback(std::string_view{l.key}, std::string_view{l.value});
+			}
+		}
+	}
+
+	//!Returns the configuration value with the given key. Throws
+	//!std::out_of_range if the item cannot be found.
+	const std::string&			operator[](std::string_view) const;
 
-	//TODO: How do we check if an entry exists?
 	//!Returns the configuration value with the given key. Does not do any
-	//!Boundary checking, so will fail if the item cannot be found.
-	std::string&				operator[](const std::string key) {return data[key];}
+	//!Boundary checking, so a new empty value is added if the item cannot be
+	//!found.
+	std::string&				operator[](std::string_view);
 
 	private:
 
-	//!Loads the data into the internal storage 
+	//!A line of the file.
+	struct line {
+		std::string		raw,		//!< Text as read, empty for added keys.
+						key,		//!< Key, for pairs.
+						value;		//!< Current value, for pairs.
+		bool			pair,		//!< True if the line is a key-value pair.
+						added;		//!< True if the pair was not in the file.
+
+		//!Returns true if the line must be written as it was read.
+		bool			unchanged() const;
+	};
+
+	//!Loads the data into the internal storage
 	void 					load();
 
+	//!Appends a new pair, returning its value.
+	std::string&				add(std::string_view, std::string_view);
+
+	//!Rebuilds the index from the lines.
+	void					rebuild_index();
+
 	std::string				filename;	//!< Path to the currently loaded file.
 	char					delimiter,	//!< Delimiter that separates keys from values.
 						comment;	//!< Character that starts a comment line.
 
-	std::map<std::string, std::string>	data;		//!< Internal data storage.
+	std::deque<line>			lines;		//!< Every line, in file order. A deque never moves its items, so the index can view their keys.
+	std::unordered_map<std::string_view, size_t>	index;	//!< Key to line index.
 };
 
 }
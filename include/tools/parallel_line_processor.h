@@ -0,0 +1,156 @@
+#pragma once
+
+#include <tools/line_reader.h>
+#include <tools/file_utils.h>
+#include <tools/worker_pool.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+namespace tools{
+
+//!Processes the lines of a large file on several threads. The file is memory
+//!mapped and split into chunks that end on a newline, which a worker_pool
+//!hands out in file order. Lines are trimmed and comments skipped per chunk
+//!as text_reader does, and line numbers are the same text_reader would
+//!report.
+class parallel_line_processor {
+
+	public:
+
+	enum		flags{
+		none=0,
+		ltrim=1, //left trim each line
+		rtrim=2, //right trim each line
+		ignorewscomment=4 //ignores whitespace when looking for the comment character. Has no effect it ltrim is active.
+	};
+
+	//!Maps the file and splits it into chunks of about the given size in
+	//!bytes. A thread count of zero uses worker_pool::shared(), any other
+	//!starts a pool of that many threads, the caller included, for the life
+	//!of the processor. Throws std::runtime_error if the file cannot be
+	//!opened.
+						parallel_line_processor(const std::string&, char='#', int=none, size_t=0, size_t=1 << 20);
+
+	//!Same as above, running on the given pool, which must outlive the
+	//!processor. Lets many files share a set of threads.
+						parallel_line_processor(const std::string&, worker_pool&, char='#', int=none, size_t=1 << 20);
+
+	//!Calls the callback with each line and its line number, concurrently
+	//!and in no particular order, so the callback must be thread safe. The
+	//!first exception thrown by a callback stops the processing and is
+	//!rethrown.
+	template<typename F>
+	void				for_each_line(F&& _callback) {
+
+		pool->run(chunks.size(), [this, &_callback](size_t _chunk) {
+			scan_chunk(_chunk, _callback);
+		});
+	}
+
+	//!Calls the map function with each line and its line number concurrently,
+	//!then calls the consume function with every result in input order on the
+	//!calling thread, as soon as all lines before it have been mapped. Only
+	//!the consume function sees lines in order, the map function must be
+	//!thread safe.
+	template<typename M, typename C>
+	void				for_each_line_ordered(M&& _map, C&& _consume) {
+
+		using result=decltype(_map(std::string_view{}, 0u));
+
+		std::vector<std::vector<result>>	results(chunks.size());
+		std::vector<char>					done(chunks.size(), false);
+		std::mutex							mutex;
+		std::condition_variable				ready;
+		bool								failed=false;
+
+		auto task=[&](size_t _chunk) {
+
+			try {
+				scan_chunk(_chunk, [&](std::string_view _line, unsigned int _number) {
+					results[_chunk].push_back(_map(_line, _number));
+				});
+			}
+			catch(...) {
+				std::lock_guard<std::mutex> lock(mutex);
+				failed=true;
+				ready.notify_one();
+				throw;
+			}
+
+			std::lock_guard<std::mutex> lock(mutex);
+			done[_chunk]=true;
+			ready.notify_one();
+		};
+
+		auto merge=[&]() {
+
+			for(size_t index=0; index<chunks.size(); index++) {
+
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					ready.wait(lock, [&]() {return done[index] || failed;});
+					if(!done[index]) {
+						return;
+					}
+				}
+
+				for(auto& item : results[index]) {
+					_consume(std::move(item));
+				}
+
+				//Free each chunk as soon as it is consumed.
+				std::vector<result>{}.swap(results[index]);
+			}
+		};
+
+		pool->run(chunks.size(), task, merge);
+	}
+
+	//!Returns the number of chunks the file was split into.
+	size_t				get_chunk_count() const {return chunks.size();}
+
+	//!Returns the number of threads working on the file, the caller included.
+	size_t				get_thread_count() const {return pool->get_thread_count();}
+
+	private:
+
+	//!A newline aligned slice of the file.
+	struct chunk {
+		std::string_view	data;			//!< Contents, ending in a newline unless it is the last one.
+		unsigned int		first_line;		//!< Lines in the file before this chunk.
+	};
+
+	//!Splits the mapped file into chunks and counts the lines before each.
+	void				split(size_t);
+
+	//!Calls the callback with every line of the chunk that survives the
+	//!flags, along with its line number.
+	template<typename F>
+	void				scan_chunk(size_t _index, F&& _callback) const {
+
+		const auto& current=chunks[_index];
+		line_reader<view_line_source> reader{comment, line_flags};
+		reader.get_source().set(current.data);
+
+		std::string_view line;
+		while(reader.next(line)) {
+			_callback(line, current.first_line+reader.get_line_number());
+		}
+	}
+
+	mapped_file			file;			//!< Mapped contents.
+	char				comment;		//!< Comment char.
+	int					line_flags;		//!< Trimming and comment flags.
+	std::unique_ptr<worker_pool>	own_pool;	//!< Pool started for this processor, if any.
+	worker_pool *		pool;			//!< Pool doing the work.
+	std::vector<chunk>	chunks;			//!< File slices.
+};
+
+}
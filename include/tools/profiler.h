@@ -0,0 +1,167 @@
+#pragma once
+
+#include <tools/chrono.h>
+
+#include <string>
+#include <vector>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+//!Opens a profiler zone named by the given string literal that closes at the
+//!end of the enclosing scope. Expands to nothing unless the library is built
+//!with the profiler (BUILD_PROFILER in cmake, which defines WITH_PROFILER).
+#ifdef WITH_PROFILER
+#define TOOLS_PROFILE_CONCAT_IMPL(_a, _b) _a##_b
+#define TOOLS_PROFILE_CONCAT(_a, _b) TOOLS_PROFILE_CONCAT_IMPL(_a, _b)
+#define TOOLS_PROFILE_ZONE(_name) tools::profiler_zone TOOLS_PROFILE_CONCAT(tools_profiler_zone_, __LINE__){_name}
+#else
+#define TOOLS_PROFILE_ZONE(_name) do {} while(0)
+#endif
+
+namespace tools{
+
+//!A finished zone.
+struct profiler_event {
+	const char *	name;		//!< Zone name.
+	std::uint64_t	begin,		//!< Start, in nanoseconds of tsc_clock.
+					end;		//!< End, in nanoseconds of tsc_clock.
+	std::uint32_t	depth,		//!< Zones open in the thread when it began.
+					thread;		//!< Index of the thread, in order of first use.
+};
+
+//!Aggregated figures of every zone with the same name, in nanoseconds.
+struct profiler_zone_stats {
+	std::string		name;		//!< Zone name.
+	std::size_t		count;		//!< Times the zone was closed.
+	std::uint64_t	total,		//!< Sum of all durations.
+					min,		//!< Shortest duration.
+					max,		//!< Longest duration.
+					p50,		//!< Median duration.
+					p95,		//!< 95th percentile.
+					p99;		//!< 99th percentile.
+};
+
+//!Collects the zones of every thread.
+
+//!Each thread records into its own ring buffer without locking, keeping the
+//!last ring_capacity zones. The slots are relaxed atomics, so collecting
+//!from another thread while zones are being closed is well defined: the
+//!writer announces each slot before filling it and zones overwritten during
+//!the copy are dropped. When a thread exits its zones are copied out and its
+//!ring is kept for the next thread, so short lived threads do not each
+//!leave a ring behind.
+class profiler {
+
+	public:
+
+	//!Zones kept per thread.
+	static constexpr std::size_t	ring_capacity=1 << 16;
+
+	//!Returns the profiler.
+	static profiler&				get();
+
+	//!Returns the current time in nanoseconds.
+	static std::uint64_t			now() {return tsc_clock::now().time_since_epoch().count();}
+
+	//!Marks a zone as open in the calling thread, returning its depth.
+	std::uint32_t					enter();
+
+	//!Closes the zone of the calling thread opened at the given time and
+	//!records it. The name must outlive the profiler, as a string literal.
+	void							leave(const char *, std::uint64_t, std::uint32_t);
+
+	//!Returns the recorded zones of every thread, sorted by start time.
+	std::vector<profiler_event>		events() const;
+
+	//!Returns the figures of every zone name, sorted by name.
+	std::vector<profiler_zone_stats>	stats() const;
+
+	//!Returns the recorded zones in Chrome trace event JSON, which
+	//!chrome://tracing and Perfetto open.
+	std::string						chrome_trace() const;
+
+	//!Writes chrome_trace to the file. Throws std::runtime_error if the file
+	//!cannot be written.
+	void							save_chrome_trace(const std::string&) const;
+
+	//!Forgets every recorded zone.
+	void							clear();
+
+	private:
+
+	//!A zone in a ring, read by the collector while its thread writes.
+	struct slot {
+		std::atomic<const char *>				name{nullptr};	//!< Zone name.
+		std::atomic<std::uint64_t>				begin{0},	//!< Start.
+												end{0};		//!< End.
+		std::atomic<std::uint32_t>				depth{0};	//!< Nesting depth.
+	};
+
+	//!Recorded zones of a single thread. Only that thread writes.
+	struct ring {
+		std::array<slot, ring_capacity>			events;		//!< Zones, head modulo capacity is the next one.
+		std::atomic<std::uint64_t>				started{0},	//!< Zones whose slot is being or was written.
+												head{0},	//!< Zones ever written.
+												tail{0};	//!< Zones written before the last clear.
+		std::uint32_t							thread{0};	//!< Thread index.
+		std::uint32_t							depth{0};	//!< Open zones.
+	};
+
+	//!Hands the ring of a thread back to the profiler when the thread exits.
+	struct ring_owner {
+		ring *									owned{nullptr};	//!< Ring of the thread, if it profiled.
+												~ring_owner();
+	};
+
+								profiler()=default;
+
+	//!Returns the ring of the calling thread, taking one on first use.
+	ring&						local_ring();
+
+	//!Copies the zones of the ring of an exiting thread out and keeps the
+	//!ring for the next thread.
+	void						release(ring&);
+
+	//!Appends the zones of the ring with indexes in [first, last).
+	static void					copy(const ring&, std::uint64_t, std::uint64_t, std::vector<profiler_event>&);
+
+	mutable std::mutex						mutex;	//!< Guards the ring lists and the zones of exited threads.
+	std::vector<std::unique_ptr<ring>>		rings,	//!< Rings of running threads.
+											spare;	//!< Rings of exited threads, to be reused.
+	std::vector<profiler_event>				exited;	//!< Zones of exited threads.
+	std::uint32_t							threads{0};	//!< Threads that took a ring.
+};
+
+//!Scoped zone: opens when built and is recorded when destroyed. Usually
+//!created through TOOLS_PROFILE_ZONE, so it vanishes when the profiler is
+//!not built.
+class profiler_zone {
+
+	public:
+
+#ifdef WITH_PROFILER
+	//!Opens the zone. The name must outlive the profiler, as a string literal.
+	explicit					profiler_zone(const char * _name)
+		:name{_name}, depth{profiler::get().enter()}, begin{profiler::now()} {}
+
+								~profiler_zone() {profiler::get().leave(name, begin, depth);}
+#else
+	explicit					profiler_zone(const char *) {}
+#endif
+
+								profiler_zone(const profiler_zone&)=delete;
+	profiler_zone&				operator=(const profiler_zone&)=delete;
+
+#ifdef WITH_PROFILER
+	private:
+
+	const char *				name;	//!< Zone name.
+	std::uint32_t				depth;	//!< Nesting depth.
+	std::uint64_t				begin;	//!< Start time.
+#endif
+};
+
+}
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <tools/line_reader.h>
+
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <vector>
 
@@ -28,39 +31,46 @@ class string_reader {
 	//!Reads the next line. If the next line is empty or is a comment will try to read the next one. A blank string is returned when no more lines are available.
 	std::string         read_line();
 
+	//!Reads the next line into the view without copying it, following the
+	//!rules of the other read_line. Returns false when no more lines are
+	//!available. The view lives until "set" is called.
+	bool                read_line(std::string_view&);
+
 	//!Sets the contents of the reader.
 	bool                set(const std::string&);
 
-	//!Returns stream state.
-	/*explicit*/ operator bool() const {return (bool)stream;}
+	//!Returns true if the contents have not been completely read.
+	/*explicit*/ operator bool() const {return !reader.is_finished();}
 
 	//!Returns the current line number (comments and blank lines are considered).
-	unsigned int        get_line_number() const {return line_number;}
+	unsigned int        get_line_number() const {return reader.get_line_number();}
 
 	//!Returns the current comment char.
-	char                get_comment() const {return comment;}
+	char                get_comment() const {return reader.get_comment();}
 
 	//!Returns true if the file has been completely read.
-	bool                is_eof() const {return stream.eof();}
+	bool                is_eof() const {return reader.is_finished();}
 
 	//!Sets a new commenting character.
-	void                set_comment(const char v) {comment=v;}
+	void                set_comment(const char v) {reader.set_comment(v);}
 
 	//!Sets the flags.
-	void                set_flags(int _v) {flags=_v;}
+	void                set_flags(int _v) {reader.set_flags(_v);}
 
 	//!Sets the pointer back at the first line.
-	void                rewind(){stream.seekg(0, stream.beg);}
+	void                rewind(){reader.rewind();}
 
-	private:
+	//!Returns an input range over the remaining lines, as string_views.
+	line_range<string_reader> lines() {return line_range<string_reader>{*this};}
 
-	//!Returns true if the line is a comment. Assumes that the line has length.
-	bool                is_comment(const std::string&);
+	//!Calls the callback with each remaining line as a string_view. If the
+	//!callback returns a bool, reading stops when it returns false.
+	template<typename F>
+	void                for_each_line(F&& _callback) {tools::for_each_line(*this, std::forward<F>(_callback));}
+
+	private:
 
-	unsigned int        line_number;    //!< Current line number.
-	char                comment;        //!< Current comment char.
-	std::stringstream   stream;         //!< File data.
-	int                 flags;
+	line_reader<string_line_source>	reader;	//!< Line scanner over the contents.
 };
 
 }
@@ -1,11 +1,65 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
+#include <array>
 #include <map>
+#include <iterator>
+#include <type_traits>
 
 namespace tools{
 
+//!Appends the items of the range to the buffer, separated by the third
+//!parameter. Items may be anything convertible to std::string_view
+//!(std::string, std::string_view, const char *) and the separator can also
+//!be a char. The final length is computed first so the buffer grows once.
+template<typename R, typename S>
+std::string&				implode(std::string& _out, const R& _range, const S& _separator) {
+
+	std::string_view separator;
+	if constexpr (std::is_same<S, char>::value) {
+		separator=std::string_view{&_separator, 1};
+	}
+	else {
+		separator=_separator;
+	}
+
+	size_t length=0, count=0;
+	for(const auto& item : _range) {
+		length+=std::string_view{item}.size();
+		++count;
+	}
+
+	if(!count) {
+		return _out;
+	}
+
+	_out.reserve(_out.size()+length+(separator.size()*(count-1)));
+
+	bool first=true;
+	for(const auto& item : _range) {
+
+		if(!first) {
+			_out.append(separator);
+		}
+
+		_out.append(std::string_view{item});
+		first=false;
+	}
+
+	return _out;
+}
+
+//!Creates a string from the range, following the rules of the appending
+//!version of implode.
+template<typename R, typename S>
+std::string					implode(const R& _range, const S& _separator) {
+
+	std::string result;
+	return implode(result, _range, _separator);
+}
+
 //!Creates a string from the vector, separated by the second parameter.
 std::string					implode(const std::vector<std::string>&, const char);
 
@@ -13,17 +67,108 @@ std::string					implode(const std::vector<std::string>&, const char);
 std::string					implode(const std::vector<std::string>&, const std::string&);
 
 //!Splits a string by a given char and returns it in a vector of size as large
-//!as the "max" parameter. If max is zero the length is unbound.
+//!as the "max" parameter, the last item holding the unsplit remainder. If max
+//!is zero the length is unbound.
 std::vector<std::string> 		explode(const std::string &, const char, size_t max=0);
 
 //!Splits a string by a given string and returns it in a vector of size as large
-//!as the "max" parameter. If max is zero the length is unbound.
+//!as the "max" parameter, the last item holding the unsplit remainder. If max
+//!is zero the length is unbound.
 std::vector<std::string> 		explode(const std::string &, const std::string&, size_t max=0);
 
+//!Lazy splitter over a string_view: yields the pieces of the subject as
+//!string_views, without allocating. The subject must outlive the range and
+//!its iterators. The "max" parameter follows the same rules as in "explode".
+class split_range {
+
+	public:
+
+	//!Forward iterator over the pieces of the subject.
+	class iterator {
+
+		public:
+
+		using iterator_category=std::forward_iterator_tag;
+		using value_type=std::string_view;
+		using difference_type=std::ptrdiff_t;
+		using pointer=const std::string_view*;
+		using reference=const std::string_view&;
+
+		//!Constructs an end iterator.
+							iterator()=default;
+
+		reference			operator*() const {return current;}
+		pointer				operator->() const {return &current;}
+		iterator&			operator++();
+		iterator			operator++(int);
+		bool				operator==(const iterator&) const;
+		bool				operator!=(const iterator& _o) const {return !(*this==_o);}
+
+		private:
+
+		friend class		split_range;
+
+							iterator(const split_range&);
+		//!Locates the next piece, or becomes an end iterator if there is none.
+		void				advance();
+
+		const split_range *	range{nullptr};	//!< Range being iterated, null for the end iterator.
+		std::string_view	current;		//!< Current piece.
+		size_t				next{0},		//!< Position where the next piece starts.
+							splits{0};		//!< Pieces split off so far.
+		bool				last{false};	//!< True when the current piece is the last one.
+	};
+
+	//!Constructs a range splitting the subject by a single char.
+						split_range(std::string_view, char, size_t max=0);
+
+	//!Constructs a range splitting the subject by a string. An empty
+	//!delimiter yields the whole subject as a single piece.
+						split_range(std::string_view, std::string_view, size_t max=0);
+
+	iterator			begin() const {return iterator{*this};}
+	iterator			end() const {return iterator{};}
+
+	private:
+
+	//!Returns the position of the next delimiter from the given position, or npos.
+	size_t				find(size_t) const;
+
+	std::string_view	subject,		//!< String being split.
+						delimiter;		//!< Delimiter, when it is a string.
+	char				delimiter_char;	//!< Delimiter, when it is a single char.
+	size_t				delimiter_size,	//!< Length of the delimiter.
+						max_splits;		//!< Maximum splits before the remainder is yielded.
+};
+
+//!Splits a string_view by a given char following the rules of "explode",
+//!without copying the pieces. The subject must outlive the result.
+std::vector<std::string_view>	split_view(std::string_view, const char, size_t max=0);
+
+//!Splits a string_view by a given string following the rules of "explode",
+//!without copying the pieces. The subject must outlive the result.
+std::vector<std::string_view>	split_view(std::string_view, std::string_view, size_t max=0);
+
 //!In the string given as the first argument, replaces each occurrence of the
 //!second argument with the third. The subject string will be altered and returned.
 std::string&				replace(std::string&, const std::string&, const std::string&);
 
+//!Returns true if the char is ASCII whitespace (space, \t, \n, \v, \f or \r).
+//!Unlike std::isspace, it does not depend on the locale.
+bool					is_whitespace(char);
+
+//!Returns true if the string is empty or only has ASCII whitespace.
+bool					is_blank(std::string_view);
+
+//!Returns a view of the string without leading ASCII whitespace.
+std::string_view			ltrim_view(std::string_view);
+
+//!Returns a view of the string without trailing ASCII whitespace.
+std::string_view			rtrim_view(std::string_view);
+
+//!Returns a view of the string without leading nor trailing ASCII whitespace.
+std::string_view			trim_view(std::string_view);
+
 //!Trims the string of whitespace characters from the left, changing and returning it.
 std::string& 				ltrim(std::string&);
 //!Trims the string of whitespace characters from the right, changing and returning it.
@@ -43,7 +188,41 @@ std::string 				str_trim(const std::string&);
 //!Returns a new string following the "replace" prototype.
 std::string				str_replace(const std::string&, const std::string&, const std::string&);
 
+//!Replaces many search strings at once. Built once from a table of search
+//!and replacement pairs into an Aho-Corasick automaton, then applied in a
+//!single pass over the subject. Matches are leftmost-longest: the earliest
+//!match wins and, among those starting at the same place, the longest.
+//!Replaced text is not scanned again. Empty search strings are ignored and
+//!repeated ones keep the last replacement.
+class replacer {
+
+	public:
+
+	using table=std::vector<std::pair<std::string, std::string>>;
+
+	//!Builds the automaton from the table of search and replacement pairs.
+							replacer(const table&);
+
+	//!Returns a new string with all replacements applied to the subject.
+	std::string				apply(std::string_view) const;
+
+	//!Appends the subject with all replacements applied to the buffer.
+	void					apply(std::string_view, std::string&) const;
+
+	private:
+
+	static constexpr int	no_pattern=-1;
+
+	size_t					classes;		//!< Amount of byte classes, 0 for bytes not in any pattern.
+	std::array<unsigned short, 256>	byte_class;	//!< Maps each byte to its class.
+	std::vector<int>		transitions;	//!< Full transition table, one row of "classes" per state.
+	std::vector<int>		longest;		//!< Longest pattern ending on each state, or no_pattern.
+	std::vector<size_t>		depth;			//!< Length of the prefix each state represents.
+	table					patterns;		//!< Search and replacement pairs.
+};
+
 //!Returns the number of octets that should follow the beginning of a UTF8 string.
+//!See utf8.h for validation, decoding and counting of complete strings.
 unsigned short int 			utf8_begin_bytes(const char);
 
 //!Checks if the UTF8 mark corresponds to a 2-octet character.
@@ -2,10 +2,14 @@
 
 #include <string>
 #include <stdexcept>
+#include <chrono>
+#include <atomic>
+#include <future>
+#include <functional>
 
 namespace tools {
 
-class exec_exception:	
+class exec_exception:
 	public std::runtime_error {
 	public:
 		exec_exception(const std::string&);
@@ -14,9 +18,83 @@ class exec_exception:
 struct exec_result {
 	int 			code;
 	std::string		output;
+	std::string		error={};		//!< Standard error, only captured by exec_process.
+	bool			killed=false;	//!< True if the process was killed by timeout or kill().
+	bool			timed_out=false;	//!< True if the process was killed by timeout.
 };
 
 exec_result exec(const char *, size_t=256);
 
+//!Options for a process run through exec_process.
+struct exec_options {
+	std::string					input={};	//!< Written to the standard input of the process, which is closed afterwards.
+	std::chrono::milliseconds	timeout{0};	//!< The process is killed after this time, zero means never.
+};
+
+//!A command run by the shell (/bin/sh -c) in a child process started
+//!with posix_spawn. Its standard output and error are read concurrently
+//!through pipes while its standard input is fed, so neither side blocks on a
+//!full pipe. The process is killed and reaped if the object is destroyed
+//!before wait() returns. exec_process(command, options).wait() is the
+//!blocking form.
+class exec_process {
+
+	public:
+
+	//!Starts the command. Throws exec_exception if the pipes cannot be
+	//!created or the process cannot be spawned. The timeout counts from here.
+							exec_process(const std::string&, const exec_options& ={});
+							~exec_process();
+							exec_process(const exec_process&)=delete;
+	exec_process&			operator=(const exec_process&)=delete;
+
+	//!Feeds the input, captures the output until the process exits or is
+	//!killed and returns the result. Can only be called once, further calls
+	//!throw exec_exception.
+	exec_result				wait();
+
+	//!Asks the process to be killed. Safe to call from any thread while
+	//!another one is in wait(), and harmless once the process has exited.
+	void					kill();
+
+	//!Returns the process id.
+	int						get_pid() const {return pid;}
+
+	private:
+
+	//!Closes the given descriptor if open.
+	static void				close_fd(int&);
+
+	//!Kills the process and closes the output pipes, which another process
+	//!spawned by the command could be keeping open.
+	void					terminate();
+
+	//!Waits for the process to exit, returning its status.
+	int						reap();
+
+	std::string				input;			//!< Pending standard input.
+	std::chrono::steady_clock::time_point	deadline;	//!< Kill time, if there is a timeout.
+	bool					has_deadline;	//!< True if there is a timeout.
+	int						pid=-1,			//!< Child process id.
+							in_fd=-1,		//!< Write end of the child's standard input.
+							out_fd=-1,		//!< Read end of the child's standard output.
+							err_fd=-1,		//!< Read end of the child's standard error.
+							wake_read=-1,	//!< Self-pipe that wakes wait() on kill().
+							wake_write=-1;
+	std::atomic<bool>		kill_requested{false},	//!< Set by kill().
+							reaped{false};	//!< True once the process has been waited for.
+	bool					waited=false;	//!< True once wait() was called.
+};
+
+//!Runs the command through exec_process in another thread. The result is
+//!delivered through the future.
+std::future<exec_result> exec_async(const std::string&, const exec_options& ={});
+
+//!Runs the command through exec_process in another thread and calls the
+//!callback with the result there. The future is ready once the callback
+//!has returned and rethrows anything it or the process threw. As with
+//!std::async, discarding the future waits for the whole run.
+std::future<void> exec_async(const std::string&, const exec_options&, std::function<void(exec_result)>);
+
 }
 
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <tools/line_reader.h>
+
 #include <string>
-#include <fstream>
+#include <string_view>
 #include <vector>
 
 namespace tools{
@@ -27,43 +29,69 @@ class text_reader {
 	//!Reads the next line. If the next line is empty or is a comment will try to read the next one. A blank string is returned when no more lines are available.
 	std::string 		read_line();
 
+	//!Reads the next line into the view without copying it, following the
+	//!rules of the other read_line. Returns false when no more lines are
+	//!available. The view lives as long as the file stays open.
+	bool			read_line(std::string_view&);
+
 	//!Opens a new file. Returns true if the file could be opened.
 	bool 			open_file(const std::string&);
 
-	//!Returns true if the reader has an assigned file. Useful to evaluate after "open_file."
-	/*explicit*/ operator bool() const {return (bool)file;}
+	//!Returns true if the reader has an assigned file that has not been
+	//!completely read. Useful to evaluate after "open_file."
+	/*explicit*/ operator bool() const {return reader.get_source().is_open() && !reader.is_finished();}
 
 	//!Returns the current line number (comments and blank lines are considered).
-	unsigned int 		get_line_number() const {return line_number;}
+	unsigned int 		get_line_number() const {return reader.get_line_number();}
 
 	//!Returns the current comment char.
-	char 			get_comment() const {return comment;}
+	char 			get_comment() const {return reader.get_comment();}
 
 	//!Returns true if the file has been completely read.
-	bool 			is_eof() const {return file.eof();}
+	bool 			is_eof() const {return reader.is_finished();}
 
 	//!Sets a new commenting character.
-	void 			set_comment(const char v) {comment=v;}
+	void 			set_comment(const char v) {reader.set_comment(v);}
 
 	//!Sets the flags.
-	void			set_flags(int _v) {flags=_v;}
+	void			set_flags(int _v) {reader.set_flags(_v);}
 
 	//!Sets the file pointer back at the first line.
-	void 			rewind(){file.seekg(0, file.beg);}
+	void 			rewind(){reader.rewind();}
 
-	//TODO: ADD A FOREACH FUNCTION THAT GETS THE CALLBACK AS A PARAMETER.
+	//!Returns an input range over the remaining lines, as string_views.
+	line_range<text_reader>	lines() {return line_range<text_reader>{*this};}
 
-	private:
+	//!Calls the callback with each remaining line as a string_view. If the
+	//!callback returns a bool, reading stops when it returns false.
+	template<typename F>
+	void			for_each_line(F&& _callback) {tools::for_each_line(*this, std::forward<F>(_callback));}
 
-	//!Returns true if the line is a comment. Assumes that the line has length.
-	bool            is_comment(const std::string&);
+	private:
 
-	unsigned int    line_number;    //!< Current line number.
-	char            comment;        //!< Current comment char.
-	std::ifstream   file;           //!< File data.
-	int				flags;
+	line_reader<mapped_line_source>	reader;	//!< Line scanner over the mapped file.
 };
 
 //!Returns a vector of strings resulting of extracting the contents of a file separated by newlines.
 std::vector<std::string> explode_lines_from_file(const std::string&);
+
+//!Lines of a file stored back to back in a single buffer.
+struct line_buffer {
+
+	std::string			buffer;		//!< All lines, without newlines.
+	std::vector<size_t>	offsets;	//!< Start of each line in the buffer, plus the end of the last.
+
+	//!Returns the amount of lines.
+	size_t				size() const {return offsets.empty() ? 0 : offsets.size()-1;}
+
+	//!Returns the line with the given index, which must be valid.
+	std::string_view	operator[](size_t _i) const {
+
+		return std::string_view{buffer}.substr(offsets[_i], offsets[_i+1]-offsets[_i]);
+	}
+};
+
+//!Returns the same lines as explode_lines_from_file in a single buffer with
+//!their offsets, instead of one string per line.
+line_buffer				explode_lines_to_buffer(const std::string&);
 }
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <stdexcept>
+
+namespace tools {
+
+//!Thrown when malformed UTF8 data is decoded.
+class utf8_exception
+	:public std::runtime_error {
+	public:
+
+	//!Class constructor with the offset of the offending byte.
+					utf8_exception(size_t);
+
+	size_t			offset;	//!< Byte offset where the invalid sequence begins.
+};
+
+//!Returns the byte offset of the first invalid UTF8 sequence in the string,
+//!or std::string_view::npos if it is valid. Overlong forms, surrogates,
+//!code points above U+10FFFF and truncated sequences are all invalid.
+size_t				utf8_find_invalid(std::string_view);
+
+//!Returns true if the string is valid UTF8.
+bool				utf8_validate(std::string_view);
+
+//!Returns the number of code points in the string, counted as the number of
+//!bytes that are not continuation bytes. Assumes valid UTF8.
+size_t				utf8_length(std::string_view);
+
+//!Decodes the code point that begins at the given byte position and moves
+//!the position past it. Throws utf8_exception if the sequence is invalid.
+char32_t			utf8_decode(std::string_view, size_t&);
+
+//!Transcodes the UTF8 string to UTF32. Throws utf8_exception if the string
+//!is not valid UTF8.
+std::u32string		utf8_to_utf32(std::string_view);
+
+//!Returns the longest prefix of the string that fits in the given amount of
+//!bytes without splitting a code point or separating combining marks,
+//!joiners, variation selectors and emoji modifiers from their base. Assumes
+//!valid UTF8.
+std::string_view	utf8_truncate_bytes(std::string_view, size_t);
+
+//!Returns the longest prefix of the string with at most the given amount of
+//!code points, under the same rules as utf8_truncate_bytes.
+std::string_view	utf8_truncate(std::string_view, size_t);
+
+}
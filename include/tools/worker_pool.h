@@ -0,0 +1,77 @@
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <cstdint>
+
+namespace tools{
+
+//!A fixed set of threads that run batches of indexed tasks. Threads are
+//!started once and sleep between batches, so calling run every frame or
+//!simulation tick costs a wake up instead of a thread spawn.
+class worker_pool {
+
+	public:
+
+	//!Starts the pool. The calling thread of run also works, so a pool for
+	//!n threads starts n-1. Zero uses the hardware thread count.
+						worker_pool(std::size_t=0);
+
+	//!Stops and joins the threads.
+						~worker_pool();
+
+						worker_pool(const worker_pool&)=delete;
+	worker_pool&		operator=(const worker_pool&)=delete;
+
+	//!Calls the task with every index in [0, count) spread over the pool
+	//!and the calling thread, and returns once all are done. Tasks are handed
+	//!out in index order, one at a time. The first exception thrown by a
+	//!task stops the rest from being handed out and is rethrown. Batches run
+	//!one at a time; a task that calls run on its own pool gets its batch
+	//!run on its thread.
+	void				run(std::size_t, const std::function<void(std::size_t)>&);
+
+	//!Same as run, but the calling thread runs the second function while the
+	//!pool works on the tasks, then helps with whatever is left. When the
+	//!batch runs in place the function is called after the tasks, so it must
+	//!not wait for tasks that have not been handed out. An exception thrown
+	//!by it stops the batch and is rethrown. It must not run batches on this
+	//!pool.
+	void				run(std::size_t, const std::function<void(std::size_t)>&, const std::function<void()>&);
+
+	//!Returns the amount of threads working on a batch, the caller included.
+	std::size_t			get_thread_count() const {return workers.size()+1;}
+
+	//!Returns a pool for the whole process with the hardware thread count,
+	//!started on first use.
+	static worker_pool&	shared();
+
+	private:
+
+	//!Waits for batches and works on them.
+	void				worker_loop();
+
+	//!Runs tasks of the current batch until there are none left.
+	void				work();
+
+	std::vector<std::thread>	workers;	//!< Threads, the caller not included.
+	std::mutex			mutex,			//!< Guards the batch and the counters.
+						run_mutex;		//!< Lets one batch run at a time.
+	std::condition_variable	wake,		//!< Signals a new batch or the stop.
+						finished;		//!< Signals the last worker leaving a batch.
+	const std::function<void(std::size_t)> *	task{nullptr};	//!< Task of the batch.
+	std::size_t			count{0},		//!< Tasks in the batch.
+						busy{0};		//!< Workers still in the batch.
+	std::atomic<std::size_t>	next{0};	//!< Next task to hand out.
+	std::atomic<bool>	failed{false};	//!< Set when a task throws.
+	std::exception_ptr	error;			//!< First exception thrown.
+	std::uint64_t		batch{0};		//!< Batches started.
+	bool				stopping{false};	//!< Set to stop the threads.
+};
+
+}
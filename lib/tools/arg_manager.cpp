@@ -1,7 +1,6 @@
 #include <tools/arg_manager.h>
 #include <algorithm>
 #include <iostream>
-#include <sstream>
 
 using namespace tools;
 
@@ -9,19 +8,71 @@ arg_manager::arg_manager(int argc, char ** argv) {
 	init(argc, argv);
 }
 
+arg_manager::arg_manager(const arg_manager& _other)
+	:data(_other.data) {
+
+	build_index();
+}
+
+arg_manager& arg_manager::operator=(const arg_manager& _other) {
+
+	if(this!=&_other) {
+		data=_other.data;
+		build_index();
+	}
+
+	return *this;
+}
+
 void arg_manager::init(int argc, char ** argv) {
 
+	data.reserve(argc);
+
 	int i=0;
 	while(i< argc) {
 		data.push_back(t_arg(argv[i]));
 		++i;
 	}
+
+	build_index();
+}
+
+void arg_manager::build_index() {
+
+	positions.clear();
+	values.clear();
+	options.clear();
+	sorted.assign(std::begin(data), std::end(data));
+	std::sort(std::begin(sorted), std::end(sorted));
+
+	positions.reserve(data.size());
+
+	//Only the first occurrence is indexed, as the linear searches always found that one.
+	for(size_t i=0; i<data.size(); i++) {
+
+		const std::string_view arg{data[i]};
+		positions.emplace(arg, i);
+
+		const auto equal=arg.find('=');
+		if(std::string_view::npos!=equal) {
+			values.emplace(arg.substr(0, equal), arg.substr(equal+1));
+		}
+
+		if(arg.size() > 2 && 0==arg.compare(0, 2, "--")) {
+
+			const auto name=arg.substr(2, std::string_view::npos==equal ? std::string_view::npos : equal-2);
+			options.emplace(
+				name,
+				option{i, std::string_view::npos==equal ? std::string_view{} : arg.substr(equal+1), std::string_view::npos!=equal}
+			);
+		}
+	}
 }
 
 const arg_manager::t_arg arg_manager::get_argument(unsigned int p_arg) const {
 
 	try {
-		return data[p_arg];
+		return data.at(p_arg);
 	}
 	catch (...) {
 		throw arg_manager_exception("Invalid argument index");
@@ -29,47 +80,79 @@ const arg_manager::t_arg arg_manager::get_argument(unsigned int p_arg) const {
 }
 
 int arg_manager::find_index(const t_arg& val) const {
-	int i=0;
 
-	for(const auto& arg: data) {
-		if(val==arg) return i;
-		else ++i;
-	}
-
-	return -1;
+	const auto it=positions.find(val);
+	return std::end(positions)==it
+		? -1
+		: it->second;
 }
 
 int arg_manager::find_index_value(const t_arg& val) const {
 
+	//The first key=value argument of the key may come after another one
+	//beginning with the key, so the index cannot answer this one.
 	int i=0;
 	for(const auto& arg: data) {
-		if(arg.substr(0, val.size())==val) return i;
+		if(0==arg.compare(0, val.size(), val)) return i;
 		else ++i;
 	}
 
 	return -1;
 }
 
+bool arg_manager::value_exists_for(const t_arg& val) const {
+
+	//The arguments beginning with the value sort right after it.
+	const auto it=std::lower_bound(std::begin(sorted), std::end(sorted), std::string_view{val});
+	return std::end(sorted)!=it && 0==it->compare(0, val.size(), val);
+}
+
 std::string arg_manager::get_value(const t_arg& argumento, const char delimiter) const {
-	std::stringstream ss;
-	ss<<argumento<<delimiter;
-	const std::string f_index=ss.str();
 
-	auto it=std::find_if(std::begin(data), std::end(data), [&f_index](const std::string& arg)
-		{return arg.find(f_index)!=std::string::npos;});
+	return std::string{get_value_view(argumento, delimiter)};
+}
 
-	if(it==data.end()) {
-		throw arg_manager_exception("Unable to locate argument "+argumento);
-	}
-	else {
-		auto ex=explode(*it, delimiter);
-		if(ex.size()!=2) {
-			throw arg_manager_exception("Invalid delimiter for argument "+argumento);
+std::string_view arg_manager::get_value_view(std::string_view _key, const char _delimiter) const {
+
+	if('='==_delimiter) {
+
+		const auto it=values.find(_key);
+		if(std::end(values)==it) {
+			throw arg_manager_exception("Unable to locate argument "+std::string{_key});
 		}
-		else {
-			return ex[1];
+
+		return it->second;
+	}
+
+	//Other delimiters are rare enough not to be indexed.
+	for(const std::string_view arg : data) {
+
+		if(arg.size() > _key.size() && 0==arg.compare(0, _key.size(), _key) && _delimiter==arg[_key.size()]) {
+			return arg.substr(_key.size()+1);
 		}
 	}
+
+	throw arg_manager_exception("Unable to locate argument "+std::string{_key});
+}
+
+std::string_view arg_manager::get_option(std::string_view _name) const {
+
+	const auto it=options.find(_name);
+	if(std::end(options)==it) {
+		throw arg_manager_exception("Option not found: "+std::string{_name});
+	}
+
+	const auto& opt=it->second;
+	if(opt.has_value) {
+		return opt.value;
+	}
+
+	const size_t next=opt.index+1;
+	if(next >= data.size() || 0==data[next].compare(0, 2, "--")) {
+		throw arg_manager_exception("No value follows option "+std::string{_name});
+	}
+
+	return data[next];
 }
 
 const arg_manager::t_arg arg_manager::get_following(const t_arg& _v) const {
@@ -0,0 +1,223 @@
+#include <tools/arg_schema.h>
+#include <tools/string_utils.h>
+
+#include <charconv>
+
+using namespace tools;
+
+namespace {
+
+//!Converts the text to the given type, returning false if it does not fully
+//!convert.
+bool convert_value(std::string_view _text, arg_schema::types _type, std::variant<bool, long long, double, std::string>& _out) {
+
+	const char * begin=_text.data(),
+				* end=_text.data()+_text.size();
+
+	switch(_type) {
+		case arg_schema::types::flag:
+			_out=true;
+			return true;
+
+		case arg_schema::types::integer: {
+			long long v=0;
+			const auto res=std::from_chars(begin, end, v);
+			_out=v;
+			return !_text.empty() && std::errc{}==res.ec && end==res.ptr;
+		}
+
+		case arg_schema::types::real: {
+			double v=0.;
+			const auto res=std::from_chars(begin, end, v);
+			_out=v;
+			return !_text.empty() && std::errc{}==res.ec && end==res.ptr;
+		}
+
+		case arg_schema::types::text:
+			_out=std::string{_text};
+			return true;
+	}
+
+	return false;
+}
+
+const char * type_name(arg_schema::types _type) {
+
+	switch(_type) {
+		case arg_schema::types::flag:		return "flag";
+		case arg_schema::types::integer:	return "integer";
+		case arg_schema::types::real:		return "real number";
+		case arg_schema::types::text:		return "text";
+	}
+
+	return "";
+}
+
+bool is_option(std::string_view _arg) {
+
+	return _arg.size() > 2 && '-'==_arg[0] && '-'==_arg[1];
+}
+
+}
+
+arg_schema_exception::arg_schema_exception(const std::vector<std::string>& _errors)
+	:std::runtime_error(implode(_errors, '\n')), errors(_errors) {
+
+}
+
+arg_schema& arg_schema::add(const option& _option) {
+
+	if(_option.name.empty() || index.count(_option.name)) {
+		throw arg_schema_exception({"invalid or repeated option name '"+_option.name+"'"});
+	}
+
+	if(types::flag==_option.type && (_option.default_value || _option.required)) {
+		throw arg_schema_exception({"flag --"+_option.name+" can have no default value and cannot be required"});
+	}
+
+	arg_values::value check;
+	if(_option.default_value && !convert_value(*_option.default_value, _option.type, check)) {
+		throw arg_schema_exception({"default value of --"+_option.name+" is not a valid "+type_name(_option.type)});
+	}
+
+	index.emplace(_option.name, options.size());
+	options.push_back(_option);
+	return *this;
+}
+
+arg_values arg_schema::parse(const arg_manager& _args) const {
+
+	const auto& data=_args.get_data();
+	std::vector<std::string_view> args{std::begin(data), std::end(data)};
+	return parse(args);
+}
+
+arg_values arg_schema::parse(int argc, char ** argv) const {
+
+	std::vector<std::string_view> args{argv, argv+argc};
+	return parse(args);
+}
+
+arg_values arg_schema::parse(const std::vector<std::string_view>& _args) const {
+
+	arg_values result;
+	std::vector<arg_values::slot*>	slots;
+	slots.reserve(options.size());
+
+	for(const auto& opt : options) {
+		slots.push_back(&result.slots.emplace(opt.name, arg_values::slot{opt.type, {}, 0}).first->second);
+	}
+
+	std::vector<std::string> errors;
+	bool only_positionals=false;
+
+	for(size_t i=1; i<_args.size(); i++) {
+
+		const auto arg=_args[i];
+
+		if(only_positionals || !is_option(arg)) {
+
+			if(!only_positionals && "--"==arg) {
+				only_positionals=true;
+			}
+			else {
+				result.positionals.emplace_back(arg);
+			}
+
+			continue;
+		}
+
+		const auto equal=arg.find('=');
+		const auto name=arg.substr(2, std::string_view::npos==equal ? std::string_view::npos : equal-2);
+
+		const auto it=index.find(name);
+		if(std::end(index)==it) {
+			errors.push_back("unknown option --"+std::string{name});
+			continue;
+		}
+
+		const auto& opt=options[it->second];
+		auto& slot=*slots[it->second];
+
+		if(slot.given && !opt.repeatable) {
+			errors.push_back("option --"+opt.name+" given more than once");
+		}
+
+		++slot.given;
+
+		std::string_view text;
+		if(types::flag==opt.type) {
+
+			if(std::string_view::npos!=equal) {
+				errors.push_back("flag --"+opt.name+" takes no value");
+				continue;
+			}
+		}
+		else if(std::string_view::npos!=equal) {
+			text=arg.substr(equal+1);
+		}
+		else if(i+1 < _args.size() && !is_option(_args[i+1])) {
+			text=_args[++i];
+		}
+		else {
+			errors.push_back("option --"+opt.name+" needs a value");
+			continue;
+		}
+
+		arg_values::value v;
+		if(!convert_value(text, opt.type, v)) {
+			errors.push_back("value '"+std::string{text}+"' of option --"+opt.name+" is not a valid "+type_name(opt.type));
+			continue;
+		}
+
+		slot.values.push_back(std::move(v));
+	}
+
+	for(size_t i=0; i<options.size(); i++) {
+
+		const auto& opt=options[i];
+		auto& slot=*slots[i];
+
+		if(slot.given) {
+			continue;
+		}
+
+		if(opt.required) {
+			errors.push_back("missing required option --"+opt.name);
+		}
+		else if(opt.default_value) {
+			slot.values.emplace_back();
+			convert_value(*opt.default_value, opt.type, slot.values.back());
+		}
+	}
+
+	if(!errors.empty()) {
+		throw arg_schema_exception(errors);
+	}
+
+	return result;
+}
+
+size_t arg_values::count(std::string_view _name) const {
+
+	const auto it=slots.find(_name);
+	if(std::end(slots)==it) {
+		throw arg_schema_exception({"unknown option --"+std::string{_name}});
+	}
+
+	return it->second.given;
+}
+
+const arg_values::slot& arg_values::find(std::string_view _name, arg_schema::types _type) const {
+
+	const auto it=slots.find(_name);
+	if(std::end(slots)==it) {
+		throw arg_schema_exception({"unknown option --"+std::string{_name}});
+	}
+
+	if(_type!=it->second.type) {
+		throw arg_schema_exception({"option --"+std::string{_name}+" is of type "+type_name(it->second.type)+", not "+type_name(_type)});
+	}
+
+	return it->second;
+}
@@ -1,95 +1,69 @@
 #include <tools/chrono.h>
 
-using namespace tools;
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#include <cpuid.h>
+#define TOOLS_TSC_X86 1
+#elif defined(__GNUC__) && defined(__aarch64__)
+#define TOOLS_TSC_ARM64 1
+#endif
 
-void chrono::start() {
+using namespace tools;
 
-	begin=std::chrono::system_clock::now();
-	running=true;
-}
+template class tools::basic_chrono<std::chrono::steady_clock>;
+template class tools::basic_chrono<tsc_clock>;
 
-void chrono::stop() {
+std::uint64_t tsc_clock::ticks() noexcept {
 
-	end=std::chrono::system_clock::now();
-	running=false;
+#if defined(TOOLS_TSC_X86)
+	return __rdtsc();
+#elif defined(TOOLS_TSC_ARM64)
+	std::uint64_t value;
+	__asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(value));
+	return value;
+#else
+	return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
 }
 
-void chrono::pause() {
+tsc_clock::calibration_data tsc_clock::calibrate() {
 
-	if(paused || !is_running()) {
+#if defined(TOOLS_TSC_X86)
 
-		return;
+	//Only an invariant counter ticks at a constant rate across power states.
+	unsigned int eax=0, ebx=0, ecx=0, edx=0;
+	if(!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) || !(edx & (1u << 8))) {
+		return {false, 0, 0.};
 	}
 
-	paused=true;
-	pause_point=std::chrono::system_clock::now();
-}
-
-void chrono::resume() {
+	//Both clocks are read twice around a short busy wait.
+	using steady=std::chrono::steady_clock;
+	const auto steady_begin=steady::now();
+	const auto ticks_begin=ticks();
 
-	if(!paused) {
+	while(steady::now()-steady_begin < std::chrono::milliseconds(10)) {
 
-		return;
 	}
 
-	auto now=std::chrono::system_clock::now();
-	int ms_elapsed_since_pause=std::chrono::duration_cast<std::chrono::milliseconds>(now-pause_point).count();
-	begin+=std::chrono::milliseconds(ms_elapsed_since_pause);
-	paused=false;
-}
-
-unsigned long int chrono::get_milliseconds() const {
-
-	if(running) {
-
-		if(paused) {
-			return std::chrono::duration_cast<std::chrono::milliseconds>(pause_point - begin).count();
-		}
-		else {
-
-			return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - begin).count();
-		}
-	}
-	else {
-		return std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
-	}
-}
+	const auto ticks_end=ticks();
+	const auto steady_end=steady::now();
 
-unsigned long int chrono::get_seconds() const {
+	const double ns=std::chrono::duration<double, std::nano>(steady_end-steady_begin).count();
+	return {true, ticks_begin, ns/static_cast<double>(ticks_end-ticks_begin)};
 
-	if(running) {
+#elif defined(TOOLS_TSC_ARM64)
 
-		if(paused) {
-			return std::chrono::duration_cast<std::chrono::seconds>(pause_point - begin).count();
-		}
-		else {
-			return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now() - begin).count();
-		}
+	//The counter frequency is published by the system.
+	std::uint64_t frequency;
+	__asm__ __volatile__("mrs %0, cntfrq_el0" : "=r"(frequency));
+	if(!frequency) {
+		return {false, 0, 0.};
 	}
-	else {
-		return std::chrono::duration_cast<std::chrono::seconds>(end - begin).count();
-	}
-}
 
-chrono_data chrono::get_full() {
-
-	auto t=get_milliseconds();
-
-	//Hyper lazy.
-	auto ms=t % 1000;
-
-	auto seconds=(t / 1000) % 60;
-	auto minutes=(t / (1000*60)) % 60;
-	auto hours=(t / (1000*60*60)) % 24;
-
-	return {(unsigned)hours, (unsigned)minutes, (unsigned)seconds, (unsigned)ms};
-}
+	return {true, ticks(), 1e9/static_cast<double>(frequency)};
 
-void chrono::reset() {
+#else
 
-	begin=tp{};
-	end=tp{};
-	pause_point=tp{};
-	running=false;
-	paused=false;
+	return {false, 0, 0.};
+#endif
 }
@@ -0,0 +1,187 @@
+#include <tools/exec_pool.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <thread>
+
+using namespace tools;
+
+exec_pool::exec_pool(size_t _concurrency)
+	:concurrency{_concurrency ? _concurrency : std::max(1u, std::thread::hardware_concurrency())} {
+
+}
+
+size_t exec_pool::add(const std::string& _command, const exec_options& _options) {
+
+	jobs.push_back({_command, _options});
+	return jobs.size()-1;
+}
+
+void exec_pool::cancel() {
+
+	cancelled=true;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	for(auto * process : running) {
+		process->kill();
+	}
+}
+
+exec_pool::stats exec_pool::run(const std::function<void(const job_result&)>& _callback) {
+
+	using clock=std::chrono::steady_clock;
+
+	const auto start=clock::now();
+	const size_t workers=std::min(concurrency, std::max<size_t>(1, jobs.size()));
+
+	std::atomic<size_t>		next{0};
+	std::mutex				done_mutex;
+	std::condition_variable	ready;
+	std::deque<job_result>	done;
+	size_t					finished_workers=0;
+	std::exception_ptr		error;
+
+	cancelled=false;
+
+	auto fail=[&](std::exception_ptr _e) {
+		{
+			std::lock_guard<std::mutex> lock(done_mutex);
+			if(!error) {
+				error=_e;
+			}
+		}
+
+		cancel();
+	};
+
+	std::vector<std::thread> pool;
+	pool.reserve(workers);
+	for(size_t w=0; w<workers; w++) {
+
+		pool.emplace_back([&]() {
+
+			size_t index=0;
+			while(!cancelled && (index=next++) < jobs.size()) {
+
+				try {
+					const auto& current=jobs[index];
+					const auto begin=clock::now();
+
+					exec_process process(current.command, current.options);
+					{
+						std::lock_guard<std::mutex> lock(mutex);
+						running.push_back(&process);
+					}
+
+					//A cancel that came before the process was listed would miss it.
+					if(cancelled) {
+						process.kill();
+					}
+
+					auto unlist=[this, &process]() {
+						std::lock_guard<std::mutex> lock(mutex);
+						running.erase(std::find(std::begin(running), std::end(running), &process));
+					};
+
+					exec_result result;
+					try {
+						result=process.wait();
+					}
+					catch(...) {
+						unlist();
+						throw;
+					}
+
+					unlist();
+
+					const auto elapsed=std::chrono::duration_cast<duration>(clock::now()-begin);
+
+					std::lock_guard<std::mutex> lock(done_mutex);
+					done.push_back({index, current.command, std::move(result), elapsed});
+					ready.notify_one();
+				}
+				catch(...) {
+					fail(std::current_exception());
+				}
+			}
+
+			std::lock_guard<std::mutex> lock(done_mutex);
+			++finished_workers;
+			ready.notify_one();
+		});
+	}
+
+	stats result;
+
+	//Results are handed over as they come, until every worker is gone.
+	while(true) {
+
+		std::unique_lock<std::mutex> lock(done_mutex);
+		ready.wait(lock, [&]() {return !done.empty() || finished_workers==workers;});
+
+		if(done.empty()) {
+			break;
+		}
+
+		auto item=std::move(done.front());
+		done.pop_front();
+		lock.unlock();
+
+		++result.jobs;
+		result.total+=item.elapsed;
+		result.min=1==result.jobs ? item.elapsed : std::min(result.min, item.elapsed);
+		result.max=std::max(result.max, item.elapsed);
+		if(item.result.code || item.result.killed) {
+			++result.failed;
+		}
+		if(item.result.timed_out) {
+			++result.timed_out;
+		}
+
+		try {
+			_callback(item);
+		}
+		catch(...) {
+			fail(std::current_exception());
+		}
+	}
+
+	for(auto& t : pool) {
+		t.join();
+	}
+
+	jobs.clear();
+
+	if(error) {
+		std::rethrow_exception(error);
+	}
+
+	result.wall=std::chrono::duration_cast<duration>(clock::now()-start);
+	if(result.jobs) {
+		result.mean=result.total/static_cast<duration::rep>(result.jobs);
+	}
+
+	return result;
+}
+
+std::vector<exec_pool::job_result> exec_pool::run(stats * _stats) {
+
+	std::vector<job_result> results;
+	results.reserve(jobs.size());
+
+	const auto figures=run([&results](const job_result& _result) {
+		results.push_back(_result);
+	});
+
+	std::sort(std::begin(results), std::end(results), [](const job_result& _a, const job_result& _b) {
+		return _a.index < _b.index;
+	});
+
+	if(nullptr!=_stats) {
+		*_stats=figures;
+	}
+
+	return results;
+}
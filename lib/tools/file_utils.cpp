@@ -4,6 +4,14 @@
 #include <stdexcept>
 #include <iostream>
 #include <sstream>
+#include <utility>
+
+#ifndef WINBUILD
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 using namespace tools;
 
@@ -19,3 +27,116 @@ std::string tools::dump_file(const std::string& _path) {
 	ss<<f.rdbuf();
 	return ss.str();
 }
+
+mapped_file::mapped_file(const std::string& _path) {
+
+	if(!open(_path)) {
+		throw std::runtime_error(std::string{"mapped_file failed, could not open "}+_path);
+	}
+}
+
+mapped_file::mapped_file(mapped_file&& _other) noexcept {
+
+	*this=std::move(_other);
+}
+
+mapped_file::~mapped_file() {
+
+	close();
+}
+
+mapped_file& mapped_file::operator=(mapped_file&& _other) noexcept {
+
+	if(this!=&_other) {
+
+		close();
+		begin=std::exchange(_other.begin, nullptr);
+		length=std::exchange(_other.length, 0);
+		opened=std::exchange(_other.opened, false);
+#ifdef WINBUILD
+		//Moving might relocate small strings.
+		contents=std::move(_other.contents);
+		begin=contents.data();
+#endif
+	}
+
+	return *this;
+}
+
+#ifdef WINBUILD
+
+bool mapped_file::open(const std::string& _path) {
+
+	close();
+
+	//Text mode, so newlines are converted as the stream readers always did.
+	std::ifstream f(_path);
+	if(!f) {
+		return false;
+	}
+
+	std::stringstream ss;
+	ss<<f.rdbuf();
+	contents=ss.str();
+	begin=contents.data();
+	length=contents.size();
+	opened=true;
+	return true;
+}
+
+void mapped_file::close() {
+
+	contents.clear();
+	begin=nullptr;
+	length=0;
+	opened=false;
+}
+
+#else
+
+bool mapped_file::open(const std::string& _path) {
+
+	close();
+
+	const int fd=::open(_path.c_str(), O_RDONLY);
+	if(-1==fd) {
+		return false;
+	}
+
+	struct stat info;
+	if(-1==fstat(fd, &info) || !S_ISREG(info.st_mode)) {
+		::close(fd);
+		return false;
+	}
+
+	//Empty files cannot be mapped, but are perfectly valid.
+	if(info.st_size) {
+
+		void * address=mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(MAP_FAILED==address) {
+			::close(fd);
+			return false;
+		}
+
+		madvise(address, info.st_size, MADV_SEQUENTIAL);
+		begin=static_cast<const char *>(address);
+		length=info.st_size;
+	}
+
+	::close(fd);
+	opened=true;
+	return true;
+}
+
+void mapped_file::close() {
+
+	if(nullptr!=begin) {
+		munmap(const_cast<char *>(begin), length);
+	}
+
+	begin=nullptr;
+	length=0;
+	opened=false;
+}
+
+#endif
@@ -0,0 +1,146 @@
+#include <tools/histogram.h>
+
+#include <rapidjson/writer.h>
+#include <rapidjson/stringbuffer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+using namespace tools;
+
+histogram::histogram()
+	:counts(bucket_count, 0) {
+
+	reset();
+}
+
+void histogram::merge(const histogram& _other) {
+
+	for(std::size_t i=0; i<bucket_count; i++) {
+		counts[i]+=_other.counts[i];
+	}
+
+	total+=_other.total;
+	sum+=_other.sum;
+	min=std::min(min, _other.min);
+	max=std::max(max, _other.max);
+}
+
+void histogram::reset() {
+
+	std::fill(std::begin(counts), std::end(counts), 0);
+	total=0;
+	sum=0;
+	min=std::numeric_limits<std::uint64_t>::max();
+	max=0;
+}
+
+std::uint64_t histogram::get_percentile(double _percentile) const {
+
+	if(!total) {
+		return 0;
+	}
+
+	const double clamped=std::min(100., std::max(0., _percentile));
+	const auto rank=std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(clamped/100.*static_cast<double>(total))));
+
+	std::uint64_t seen=0;
+	for(std::size_t i=0; i<bucket_count; i++) {
+
+		seen+=counts[i];
+		if(seen >= rank) {
+			return std::max(min, std::min(max, bucket_highest(i)));
+		}
+	}
+
+	return max;
+}
+
+std::uint64_t histogram::bucket_lowest(std::size_t _index) {
+
+	if(_index < sub_buckets) {
+		return _index;
+	}
+
+	const std::size_t shift=_index/sub_buckets-1;
+	return (sub_buckets+(_index % sub_buckets)) << shift;
+}
+
+std::uint64_t histogram::bucket_highest(std::size_t _index) {
+
+	if(_index < sub_buckets) {
+		return _index;
+	}
+
+	const std::size_t shift=_index/sub_buckets-1;
+	return bucket_lowest(_index)+((std::uint64_t{1} << shift)-1);
+}
+
+std::string histogram::to_text(bool _buckets) const {
+
+	std::stringstream ss;
+	ss<<"count="<<total
+		<<" min="<<get_min()
+		<<" mean="<<get_mean()
+		<<" p50="<<get_p50()
+		<<" p95="<<get_p95()
+		<<" p99="<<get_p99()
+		<<" max="<<get_max();
+
+	if(_buckets) {
+
+		for(std::size_t i=0; i<bucket_count; i++) {
+
+			if(counts[i]) {
+				ss<<"\n"<<bucket_lowest(i)<<"-"<<bucket_highest(i)<<" "<<counts[i];
+			}
+		}
+	}
+
+	return ss.str();
+}
+
+std::string histogram::to_json(bool _buckets) const {
+
+	rapidjson::StringBuffer buffer;
+	rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+
+	writer.StartObject();
+	writer.Key("count");
+	writer.Uint64(total);
+	writer.Key("min");
+	writer.Uint64(get_min());
+	writer.Key("mean");
+	writer.Double(get_mean());
+	writer.Key("p50");
+	writer.Uint64(get_p50());
+	writer.Key("p95");
+	writer.Uint64(get_p95());
+	writer.Key("p99");
+	writer.Uint64(get_p99());
+	writer.Key("max");
+	writer.Uint64(get_max());
+
+	if(_buckets) {
+
+		writer.Key("buckets");
+		writer.StartArray();
+		for(std::size_t i=0; i<bucket_count; i++) {
+
+			if(counts[i]) {
+				writer.StartArray();
+				writer.Uint64(bucket_lowest(i));
+				writer.Uint64(bucket_highest(i));
+				writer.Uint64(counts[i]);
+				writer.EndArray();
+			}
+		}
+		writer.EndArray();
+	}
+
+	writer.EndObject();
+
+	return std::string{buffer.GetString(), buffer.GetSize()};
+}
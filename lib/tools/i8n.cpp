@@ -4,6 +4,7 @@
 #include <tools/file_utils.h>
 #include <tools/algorithm.h>
 #include <tools/platform.h>
+#include <tools/instrumentation.h>
 
 #include <algorithm>
 #include <ctype.h>
@@ -177,6 +178,8 @@ void tools::i8n::set_language(const std::string& _lan) {
 
 std::string tools::i8n::get(const std::string& _get) const {
 
+	TOOLS_INSTRUMENT("i8n::get");
+
 	if(!codex.count(_get)) {
 		return fail_string(_get);
 	}
@@ -186,6 +189,8 @@ std::string tools::i8n::get(const std::string& _get) const {
 
 std::string tools::i8n::get(const std::string& _get, const std::vector<substitution>& _subs) const {
 
+	TOOLS_INSTRUMENT("i8n::get");
+
 	if(!codex.count(_get)) {
 		return fail_string(_get);
 	}
@@ -280,16 +285,13 @@ std::vector<tools::i8n::lexer::token> tools::i8n::lexer::from_string(const std::
 
 	std::string line;
 	int linenum=0, charnum=0;
-	auto lines=tools::explode(_raw_text, tools::newline);
 
 	//The lexer just reads line by line, storing data as tokens are found.
 	std::string buffer;
 	std::vector<tools::i8n::lexer::token>	result;
 
-	while(lines.size()) {
-		//Pop from front...
-		line=lines.front();
-		lines.erase(std::begin(lines));
+	for(const auto view : tools::split_range(_raw_text, std::string_view{tools::newline})) {
+		line.assign(view);
 		++linenum;
 		charnum=0;
 
@@ -331,7 +333,7 @@ std::vector<tools::i8n::lexer::token> tools::i8n::lexer::from_string(const std::
 	}
 
 	//!The last thing we expect is actually a delimiter, so this is an error.
-	if(str_trim(buffer).size()) {
+	if(!is_blank(buffer)) {
 		throw i8n_lexer_generic_error("non-token found at the end of the stream: '"+buffer+"'");
 	}
 
@@ -702,7 +704,7 @@ int tools::i8n::parser::find_next_of(const std::vector<lexer::token>& _tokens, l
 		}
 
 		if(lexer::tokentypes::literal==tok.type) {
-			if(!str_trim(tok.val).size()) {
+			if(is_blank(tok.val)) {
 				++_curtoken;
 				continue;
 			}
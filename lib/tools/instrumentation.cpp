@@ -0,0 +1,280 @@
+#include <tools/instrumentation.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <map>
+#include <new>
+#include <sstream>
+
+using namespace tools;
+
+namespace {
+
+//!Registered entry points and thread records. Never destroyed, so threads
+//!still running during static destruction find it alive.
+struct registry {
+
+	std::mutex											mutex;				//!< Guards the points and records.
+	std::array<const char *, instrumentation::max_points>	names{};		//!< Entry point names, by slot.
+	std::size_t											point_count{0};		//!< Registered entry points.
+	std::vector<std::unique_ptr<instrumentation::thread_record>>	records;	//!< Every thread record.
+	std::atomic<bool>									dump_at_exit{true};	//!< Whether to write the table at exit.
+};
+
+void dump_at_exit();
+
+registry& get_registry() {
+
+	static registry * instance=[]() {
+		auto created=new registry;
+		std::atexit(dump_at_exit);
+		return created;
+	}();
+
+	return *instance;
+}
+
+void dump_at_exit() {
+
+	if(!get_registry().dump_at_exit.load()) {
+		return;
+	}
+
+	if(instrumentation::stats().empty()) {
+		return;
+	}
+
+	const auto text=instrumentation::to_text();
+	std::fputs(text.c_str(), stderr);
+}
+
+//Written only by the replaced operator new of each thread.
+thread_local std::uint64_t	thread_allocation_count=0,
+							thread_allocation_bytes=0;
+
+//!Merges the slots of the given records by entry point name.
+std::vector<instrumentation_stats> collect(
+	const registry& _registry,
+	const std::vector<const instrumentation::thread_record *>& _records
+) {
+
+	std::map<std::string, instrumentation_stats> merged;
+	for(const auto * record : _records) {
+
+		for(std::size_t i=0; i<_registry.point_count; i++) {
+
+			const auto& s=record->slots[i];
+			const auto calls=s.calls.load(std::memory_order_relaxed);
+			if(!calls) {
+				continue;
+			}
+
+			auto& entry=merged[_registry.names[i]];
+			entry.name=_registry.names[i];
+			entry.calls+=calls;
+			entry.allocations+=s.allocations.load(std::memory_order_relaxed);
+			entry.bytes+=s.bytes.load(std::memory_order_relaxed);
+		}
+	}
+
+	std::vector<instrumentation_stats> result;
+	result.reserve(merged.size());
+	for(auto& pair : merged) {
+		result.push_back(std::move(pair.second));
+	}
+
+	return result;
+}
+
+}
+
+#ifdef WITH_INSTRUMENTATION
+
+namespace {
+
+void * counted_alloc(std::size_t _size) {
+
+	++thread_allocation_count;
+	thread_allocation_bytes+=_size;
+	return std::malloc(_size ? _size : 1);
+}
+
+void * counted_aligned_alloc(std::size_t _size, std::align_val_t _align) {
+
+	++thread_allocation_count;
+	thread_allocation_bytes+=_size;
+
+	//aligned_alloc wants the size to be a multiple of the alignment.
+	const auto align=static_cast<std::size_t>(_align);
+	return std::aligned_alloc(align, ((_size+align-1)/align)*align);
+}
+
+void * throwing(void * _ptr) {
+
+	if(nullptr==_ptr) {
+		throw std::bad_alloc{};
+	}
+
+	return _ptr;
+}
+
+}
+
+//The library replaces the global allocation functions of the whole program.
+void * operator new(std::size_t _size) {return throwing(counted_alloc(_size));}
+void * operator new[](std::size_t _size) {return throwing(counted_alloc(_size));}
+void * operator new(std::size_t _size, const std::nothrow_t&) noexcept {return counted_alloc(_size);}
+void * operator new[](std::size_t _size, const std::nothrow_t&) noexcept {return counted_alloc(_size);}
+void * operator new(std::size_t _size, std::align_val_t _align) {return throwing(counted_aligned_alloc(_size, _align));}
+void * operator new[](std::size_t _size, std::align_val_t _align) {return throwing(counted_aligned_alloc(_size, _align));}
+void operator delete(void * _ptr) noexcept {std::free(_ptr);}
+void operator delete[](void * _ptr) noexcept {std::free(_ptr);}
+void operator delete(void * _ptr, std::size_t) noexcept {std::free(_ptr);}
+void operator delete[](void * _ptr, std::size_t) noexcept {std::free(_ptr);}
+void operator delete(void * _ptr, std::align_val_t) noexcept {std::free(_ptr);}
+void operator delete[](void * _ptr, std::align_val_t) noexcept {std::free(_ptr);}
+void operator delete(void * _ptr, std::size_t, std::align_val_t) noexcept {std::free(_ptr);}
+void operator delete[](void * _ptr, std::size_t, std::align_val_t) noexcept {std::free(_ptr);}
+
+#endif
+
+std::size_t instrumentation::add_point(const char * _name) {
+
+	auto& reg=get_registry();
+
+	std::lock_guard<std::mutex> lock(reg.mutex);
+	if(reg.point_count==max_points) {
+		return max_points;
+	}
+
+	reg.names[reg.point_count]=_name;
+	return reg.point_count++;
+}
+
+instrumentation::thread_record& instrumentation::local_record() {
+
+	thread_local thread_record * local=nullptr;
+	if(nullptr==local) {
+
+		auto created=std::make_unique<thread_record>();
+		auto& reg=get_registry();
+
+		std::lock_guard<std::mutex> lock(reg.mutex);
+		local=created.get();
+		reg.records.push_back(std::move(created));
+	}
+
+	return *local;
+}
+
+std::vector<instrumentation_stats> instrumentation::stats() {
+
+	auto& reg=get_registry();
+
+	std::lock_guard<std::mutex> lock(reg.mutex);
+	std::vector<const thread_record *> records;
+	for(const auto& r : reg.records) {
+		records.push_back(r.get());
+	}
+
+	return collect(reg, records);
+}
+
+std::vector<instrumentation_stats> instrumentation::thread_stats() {
+
+	const auto& record=local_record();
+	auto& reg=get_registry();
+
+	std::lock_guard<std::mutex> lock(reg.mutex);
+	return collect(reg, {&record});
+}
+
+instrumentation_stats instrumentation::thread_stats(const std::string& _name) {
+
+	for(auto& s : thread_stats()) {
+
+		if(s.name==_name) {
+			return s;
+		}
+	}
+
+	return {_name, 0, 0, 0};
+}
+
+instrumentation_allocations instrumentation::thread_allocations() {
+
+	return {thread_allocation_count, thread_allocation_bytes};
+}
+
+void instrumentation::reset() {
+
+	auto& reg=get_registry();
+
+	std::lock_guard<std::mutex> lock(reg.mutex);
+	for(auto& r : reg.records) {
+
+		for(auto& s : r->slots) {
+			s.calls.store(0, std::memory_order_relaxed);
+			s.allocations.store(0, std::memory_order_relaxed);
+			s.bytes.store(0, std::memory_order_relaxed);
+		}
+	}
+}
+
+std::string instrumentation::to_text() {
+
+	const auto all=stats();
+
+	std::stringstream ss;
+	ss<<std::left<<std::setw(40)<<"entry point"
+		<<std::right<<std::setw(12)<<"calls"
+		<<std::setw(14)<<"allocations"
+		<<std::setw(14)<<"bytes"
+		<<std::setw(14)<<"allocs/call"
+		<<std::setw(14)<<"bytes/call"<<"\n";
+
+	ss<<std::fixed<<std::setprecision(1);
+	for(const auto& s : all) {
+
+		const double calls=static_cast<double>(s.calls);
+		ss<<std::left<<std::setw(40)<<s.name
+			<<std::right<<std::setw(12)<<s.calls
+			<<std::setw(14)<<s.allocations
+			<<std::setw(14)<<s.bytes
+			<<std::setw(14)<<static_cast<double>(s.allocations)/calls
+			<<std::setw(14)<<static_cast<double>(s.bytes)/calls<<"\n";
+	}
+
+	return ss.str();
+}
+
+void instrumentation::set_dump_at_exit(bool _value) {
+
+	get_registry().dump_at_exit.store(_value);
+}
+
+instrumentation_scope::instrumentation_scope(const instrumentation_point& _point)
+	:counters{nullptr}, begin{0, 0} {
+
+	if(_point.index==instrumentation::max_points) {
+		return;
+	}
+
+	//Creating the thread record allocates, so it happens before the count.
+	counters=&instrumentation::local_record().slots[_point.index];
+	instrumentation::bump(counters->calls, 1);
+	begin=instrumentation::thread_allocations();
+}
+
+instrumentation_scope::~instrumentation_scope() {
+
+	if(nullptr==counters) {
+		return;
+	}
+
+	const auto end=instrumentation::thread_allocations();
+	instrumentation::bump(counters->allocations, end.count-begin.count);
+	instrumentation::bump(counters->bytes, end.bytes-begin.bytes);
+}
@@ -67,6 +67,8 @@ bool json_config_file::has_path(
 	const std::string& _path
 ) const {
 
+	TOOLS_INSTRUMENT("json_config_file::has_path");
+
 	const rapidjson::Value * p=&document;
 	auto v=explode(_path, ':');
 	for(const auto& key : v) {
@@ -0,0 +1,77 @@
+#include <tools/line_reader.h>
+
+#include <cstring>
+
+using namespace tools;
+
+bool tools::next_line(std::string_view _data, size_t& _position, std::string_view& _line) {
+
+	if(_position >= _data.size()) {
+		return false;
+	}
+
+	const char * begin=_data.data()+_position;
+	const size_t remaining=_data.size()-_position;
+	const char * newline=static_cast<const char *>(std::memchr(begin, '\n', remaining));
+
+	if(nullptr==newline) {
+		_line=std::string_view{begin, remaining};
+		_position=_data.size();
+		return true;
+	}
+
+	_line=std::string_view{begin, static_cast<size_t>(newline-begin)};
+	_position+=_line.size()+1;
+	return true;
+}
+
+bool mapped_line_source::open(const std::string& _path) {
+
+	position=0;
+	return file.open(_path);
+}
+
+bool mapped_line_source::next(std::string_view& _line) {
+
+	return next_line(file.data(), position, _line);
+}
+
+void string_line_source::set(const std::string& _str) {
+
+	contents=_str;
+	position=0;
+}
+
+bool string_line_source::next(std::string_view& _line) {
+
+	return next_line(contents, position, _line);
+}
+
+bool view_line_source::next(std::string_view& _line) {
+
+	return next_line(data, position, _line);
+}
+
+void stream_line_source::set(std::istream& _stream) {
+
+	stream=&_stream;
+	start=_stream.tellg();
+}
+
+bool stream_line_source::next(std::string_view& _line) {
+
+	if(nullptr==stream || !std::getline(*stream, buffer)) {
+		return false;
+	}
+
+	_line=buffer;
+	return true;
+}
+
+void stream_line_source::rewind() {
+
+	if(nullptr!=stream) {
+		stream->clear();
+		stream->seekg(start);
+	}
+}
@@ -0,0 +1,262 @@
+#include <tools/matrix_2d_io.h>
+
+#include <limits>
+
+using namespace tools;
+
+namespace {
+
+const char			file_magic[4]={'T', 'M', 'X', '2'};
+const std::uint32_t	file_version=1,
+					file_byte_order=0x01020304;
+
+//!Returns the offset of the items for a header with the given index size.
+std::uint64_t data_offset_for(std::uint64_t _index_size) {
+
+	return (sizeof(matrix_2d_file_header)+_index_size+63)/64*64;
+}
+
+//!Reads the given amount of bytes, a piece at a time so a damaged size
+//!runs out of stream before it runs out of memory.
+template<typename T>
+void read_pieces(std::istream& _in, std::vector<T>& _out, std::uint64_t _bytes) {
+
+	const std::uint64_t piece=std::uint64_t{1} << 20;
+	for(std::uint64_t done=0; done < _bytes; ) {
+
+		const auto now=std::min(piece, _bytes-done);
+		_out.resize((done+now)/sizeof(T));
+		_in.read(reinterpret_cast<char *>(_out.data())+done, static_cast<std::streamsize>(now));
+		if(static_cast<std::uint64_t>(_in.gcount())!=now) {
+			throw matrix_2d_io_exception("the stream ends before the index does");
+		}
+
+		done+=now;
+	}
+}
+
+}
+
+matrix_2d_file_header matrix_2d_file_header::make(
+	kinds _kind,
+	std::size_t _element_size,
+	std::int32_t _x,
+	std::int32_t _y,
+	std::uint32_t _w,
+	std::uint32_t _h,
+	std::uint64_t _count,
+	bool _bitmap
+) {
+
+	matrix_2d_file_header result{};
+	std::copy(std::begin(file_magic), std::end(file_magic), result.magic);
+	result.version=file_version;
+	result.byte_order=file_byte_order;
+	result.kind=_kind;
+	result.element_size=static_cast<std::uint32_t>(_element_size);
+	result.x=_x;
+	result.y=_y;
+	result.w=_w;
+	result.h=_h;
+	result.count=_count;
+
+	result.layout=bitmap;
+	const auto bitmap_size=result.index_size();
+	result.layout=list;
+	if(_bitmap && bitmap_size <= result.index_size()) {
+		result.layout=bitmap;
+	}
+
+	result.data_offset=data_offset_for(result.index_size());
+	return result;
+}
+
+std::uint64_t matrix_2d_file_header::index_size() const {
+
+	if(bitmap==layout) {
+		return (cells()+63)/64*8;
+	}
+
+	return count*(fixed==kind ? 4 : 8);
+}
+
+void matrix_2d_file_header::check(kinds _kind, std::size_t _element_size) const {
+
+	if(!std::equal(std::begin(file_magic), std::end(file_magic), magic)) {
+		throw matrix_2d_io_exception("not a matrix file");
+	}
+
+	if(file_byte_order!=byte_order) {
+		throw matrix_2d_io_exception("the file was written with another byte order");
+	}
+
+	if(file_version!=version) {
+		throw matrix_2d_io_exception("unknown file version "+std::to_string(version));
+	}
+
+	if(static_cast<std::uint32_t>(_kind)!=kind) {
+		throw matrix_2d_io_exception(fixed==_kind ? "the file does not hold a matrix_2d" : "the file does not hold a matrix_2d_unbound");
+	}
+
+	if(_element_size!=element_size) {
+		throw matrix_2d_io_exception("the file holds items of "+std::to_string(element_size)+" bytes, not "+std::to_string(_element_size));
+	}
+
+	if(bitmap!=layout && list!=layout) {
+		throw matrix_2d_io_exception("unknown index layout "+std::to_string(layout));
+	}
+
+	//matrix_2d indexes its cells with 32 bits, bitmaps of matrix_2d_unbound
+	//must stay within the coordinates.
+	if(fixed==kind) {
+		if(x || y || cells() > std::numeric_limits<unsigned int>::max()) {
+			throw matrix_2d_io_exception("bad matrix_2d dimensions");
+		}
+	}
+	else if(bitmap==layout) {
+		if(static_cast<std::int64_t>(x)+w-1 > std::numeric_limits<int>::max()
+			|| static_cast<std::int64_t>(y)+h-1 > std::numeric_limits<int>::max()) {
+			throw matrix_2d_io_exception("bad matrix_2d_unbound bounds");
+		}
+	}
+
+	if((fixed==kind || bitmap==layout) && count > cells()) {
+		throw matrix_2d_io_exception("more items than cells");
+	}
+
+	//Keeps the sizes of the index and the items within 64 bits.
+	if(count > std::numeric_limits<std::uint64_t>::max()/(element_size+16)) {
+		throw matrix_2d_io_exception("bad item count");
+	}
+
+	if(data_offset_for(index_size())!=data_offset) {
+		throw matrix_2d_io_exception("bad data offset");
+	}
+}
+
+std::vector<std::uint64_t> tools::matrix_2d_file_ranks(const std::uint64_t * _words, std::size_t _count) {
+
+	std::vector<std::uint64_t> result(_count+1);
+	for(std::size_t i=0; i<_count; i++) {
+		result[i+1]=result[i]+matrix_2d_popcount(_words[i]);
+	}
+
+	return result;
+}
+
+void tools::check_matrix_2d_file_list(const matrix_2d_file_header& _header, const std::uint32_t * _list) {
+
+	if(matrix_2d_file_header::fixed==_header.kind) {
+
+		for(std::uint64_t i=0; i<_header.count; i++) {
+			if(_list[i] >= _header.cells() || (i && _list[i] <= _list[i-1])) {
+				throw matrix_2d_io_exception("the cell list is not sorted or out of bounds");
+			}
+		}
+
+		return;
+	}
+
+	auto coords_at=[_list](std::uint64_t _i) {
+		return matrix_2d_unbound_coords{static_cast<int>(_list[2*_i]), static_cast<int>(_list[2*_i+1])};
+	};
+
+	for(std::uint64_t i=1; i<_header.count; i++) {
+		if(!(coords_at(i-1) < coords_at(i))) {
+			throw matrix_2d_io_exception("the cell list is not sorted");
+		}
+	}
+}
+
+void tools::write_matrix_2d_header(
+	std::ostream& _out,
+	const matrix_2d_file_header& _header,
+	const std::vector<std::uint64_t>& _words,
+	const std::vector<std::uint32_t>& _list
+) {
+
+	static const char padding[64]={};
+
+	_out.write(reinterpret_cast<const char *>(&_header), sizeof(_header));
+	if(matrix_2d_file_header::bitmap==_header.layout) {
+		_out.write(reinterpret_cast<const char *>(_words.data()), static_cast<std::streamsize>(_words.size()*sizeof(std::uint64_t)));
+	}
+	else {
+		_out.write(reinterpret_cast<const char *>(_list.data()), static_cast<std::streamsize>(_list.size()*sizeof(std::uint32_t)));
+	}
+
+	const auto written=sizeof(_header)+_header.index_size();
+	_out.write(padding, static_cast<std::streamsize>(_header.data_offset-written));
+
+	if(!_out) {
+		throw matrix_2d_io_exception("could not write the header");
+	}
+}
+
+matrix_2d_file_header tools::read_matrix_2d_header(
+	std::istream& _in,
+	matrix_2d_file_header::kinds _kind,
+	std::size_t _element_size,
+	std::vector<std::uint64_t>& _words,
+	std::vector<std::uint32_t>& _list
+) {
+
+	matrix_2d_file_header header;
+	_in.read(reinterpret_cast<char *>(&header), sizeof(header));
+	if(sizeof(header)!=static_cast<std::size_t>(_in.gcount())) {
+		throw matrix_2d_io_exception("the stream ends before the header does");
+	}
+
+	header.check(_kind, _element_size);
+
+	if(matrix_2d_file_header::bitmap==header.layout) {
+
+		read_pieces(_in, _words, header.index_size());
+
+		//Bits past the last cell must be clear, the rest must add up.
+		const auto tail=header.cells() % 64;
+		if(tail && (_words.back() >> tail)) {
+			throw matrix_2d_io_exception("the bitmap has bits past the last cell");
+		}
+
+		if(matrix_2d_file_ranks(_words.data(), _words.size()).back()!=header.count) {
+			throw matrix_2d_io_exception("the bitmap does not match the item count");
+		}
+	}
+	else {
+		read_pieces(_in, _list, header.index_size());
+		check_matrix_2d_file_list(header, _list.data());
+	}
+
+	const auto padding=header.data_offset-sizeof(header)-header.index_size();
+	_in.ignore(static_cast<std::streamsize>(padding));
+	if(static_cast<std::uint64_t>(_in.gcount())!=padding) {
+		throw matrix_2d_io_exception("the stream ends before the items");
+	}
+
+	return header;
+}
+
+void tools::read_matrix_2d_items(std::istream& _in, char * _out, std::size_t _element_size, std::uint64_t _count) {
+
+	const auto bytes=_element_size*_count;
+	_in.read(_out, static_cast<std::streamsize>(bytes));
+	if(static_cast<std::uint64_t>(_in.gcount())!=bytes) {
+		throw matrix_2d_io_exception("the stream ends before the items do");
+	}
+}
+
+matrix_2d_item_writer::matrix_2d_item_writer(std::ostream& _out)
+	:out(_out), block(65536) {
+
+}
+
+void matrix_2d_item_writer::flush() {
+
+	out.write(block.data(), static_cast<std::streamsize>(used));
+	used=0;
+
+	if(!out) {
+		throw matrix_2d_io_exception("could not write the items");
+	}
+}
@@ -0,0 +1,83 @@
+#include <tools/pair_file_merger.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace tools;
+
+size_t pair_file_merger::add_layer(const pair_file_parser& _file) {
+
+	layers.push_back({_file.get_filename(), {}});
+	apply(layers.size()-1, _file);
+	return layers.size()-1;
+}
+
+void pair_file_merger::replace_layer(size_t _layer, const pair_file_parser& _file) {
+
+	auto& current=layers.at(_layer);
+
+	//Withdraw the old values of this layer only.
+	for(const auto key : current.keys) {
+
+		auto it=index.find(key);
+		auto& values=it->second.values;
+		values.erase(
+			std::find_if(std::begin(values), std::end(values), [_layer](const layer_value& _v) {
+				return _v.layer==_layer;
+			})
+		);
+
+		if(values.empty()) {
+			index.erase(it);
+		}
+	}
+
+	current.filename=_file.get_filename();
+	current.keys.clear();
+	apply(_layer, _file);
+}
+
+const std::string& pair_file_merger::get(std::string_view _key) const {
+
+	return find(_key).back().value;
+}
+
+size_t pair_file_merger::provenance(std::string_view _key) const {
+
+	return find(_key).back().layer;
+}
+
+void pair_file_merger::apply(size_t _layer, const pair_file_parser& _file) {
+
+	auto& keys=layers[_layer].keys;
+	keys.reserve(_file.size());
+
+	_file.for_each_pair([this, _layer, &keys](std::string_view _key, std::string_view _value) {
+
+		auto it=index.find(_key);
+		if(std::end(index)==it) {
+			auto key=std::make_unique<const std::string>(_key);
+			const std::string_view view{*key};
+			it=index.emplace(view, key_values{std::move(key), {}}).first;
+		}
+
+		//Values stay sorted by layer, so the winner is always the last one.
+		auto& values=it->second.values;
+		const auto pos=std::find_if(std::begin(values), std::end(values), [_layer](const layer_value& _v) {
+			return _v.layer > _layer;
+		});
+
+		values.insert(pos, {_layer, std::string{_value}});
+		keys.push_back(it->first);
+	});
+}
+
+const std::vector<pair_file_merger::layer_value>& pair_file_merger::find(std::string_view _key) const {
+
+	const auto it=index.find(_key);
+	if(std::end(index)==it) {
+		throw std::out_of_range("pair_file_merger has no key "+std::string{_key});
+	}
+
+	return it->second.values;
+}
@@ -1,8 +1,10 @@
 #include <tools/pair_file_parser.h>
-#include <tools/text_reader.h>
+#include <tools/line_reader.h>
+#include <tools/file_utils.h>
 #include <tools/compatibility_patches.h>
 
 #include <fstream>
+#include <stdexcept>
 
 using namespace tools;
 
@@ -17,48 +19,160 @@ pair_file_parser::pair_file_parser(const std::string& nf, char sep, char com):
 	}
 }
 
+pair_file_parser::pair_file_parser(const pair_file_parser& _other):
+	filename(_other.filename),
+	delimiter(_other.delimiter),
+	comment(_other.comment),
+	lines(_other.lines) {
+
+	rebuild_index();
+}
+
+pair_file_parser& pair_file_parser::operator=(const pair_file_parser& _other) {
+
+	if(this!=&_other) {
+
+		filename=_other.filename;
+		delimiter=_other.delimiter;
+		comment=_other.comment;
+		lines=_other.lines;
+		rebuild_index();
+	}
+
+	return *this;
+}
+
+const std::string& pair_file_parser::operator[](std::string_view _key) const {
+
+	const auto it=index.find(_key);
+	if(std::end(index)==it) {
+		throw std::out_of_range("pair_file_parser has no key "+std::string{_key});
+	}
+
+	return lines[it->second].value;
+}
+
+std::string& pair_file_parser::operator[](std::string_view _key) {
+
+	const auto it=index.find(_key);
+	return std::end(index)==it
+		? add(_key, std::string_view{})
+		: lines[it->second].value;
+}
+
 void pair_file_parser::save() {
 
+	bool changed=false;
+	size_t length=0;
+	for(const auto& l : lines) {
+
+		changed=changed || !l.unchanged();
+		length+=l.raw.size()+l.key.size()+l.value.size()+2;
+	}
+
+	if(!changed) {
+		return;
+	}
+
+	std::string buffer;
+	buffer.reserve(length);
+
+	for(const auto& l : lines) {
+
+		if(l.unchanged()) {
+			buffer+=l.raw;
+		}
+		else {
+			buffer+=l.key;
+			buffer+=delimiter;
+			buffer+=l.value;
+		}
+
+		buffer+='\n';
+	}
+
 	std::ofstream fichero(filename.c_str());
-	
-	for(const auto& par : data) {
-		fichero<<par.first<<delimiter<<par.second<<std::endl;
+	fichero.write(buffer.data(), buffer.size());
+
+	if(!fichero) {
+		throw std::runtime_error("tools::pair_file_parser::save could not write "+filename);
+	}
+
+	//What was written is now the original text of every line.
+	for(auto& l : lines) {
+
+		if(!l.unchanged()) {
+			l.raw=l.key+delimiter+l.value;
+			l.added=false;
+		}
 	}
 }
 
 void pair_file_parser::sync(const pair_file_parser& f) {
 
-	for(const auto& par : f.data) {
-		if(!data.count(par.first)) {
-			data[par.first]=f.data.at(par.first);
+	for(const auto& l : f.lines) {
+
+		if(l.pair && !index.count(l.key)) {
+			add(l.key, l.value);
 		}
 	}
 }
 
 void pair_file_parser::load() {
 
-	//TODO: This is preposterous: the text-reader could implement a foreach.
-	text_reader L(filename.c_str(), comment);
-
-	if(!L) {
+	mapped_file file;
+	if(!file.open(filename)) {
 		throw std::runtime_error("tools::pair_file_parser::load could not open "+filename);
 	}
 
-	std::string line;
+	const auto data=file.data();
+	size_t position=0;
+	std::string_view current;
 
-	while(true) {
-		line=L.read_line();
+	while(next_line(data, position, current)) {
 
-		if(L.is_eof()) {
-			break;
+		//Empty lines and comments are kept as they are.
+		if(current.empty() || comment==current.front()) {
+			lines.push_back({std::string{current}, {}, {}, false, false});
+			continue;
 		}
-		//Localizar delimiter... 
-		else if(line.find(delimiter)==line.npos) {
-			throw std::runtime_error("tools::map_pair malformed line "+compat::to_string(L.get_line_number())+" '"+line+"' in "+filename);
+
+		const auto pos=current.find(delimiter);
+		if(std::string_view::npos==pos) {
+			throw std::runtime_error("tools::map_pair malformed line "+compat::to_string(lines.size()+1)+" '"+std::string{current}+"' in "+filename);
 		}
 
-		std::vector<std::string> values=explode(line, delimiter, 2);
-		data[values[0]]=values[1];
+		lines.push_back({std::string{current}, std::string{current.substr(0, pos)}, std::string{current.substr(pos+1)}, true, false});
+
+		//Repeated keys: the last one wins, as it always did.
+		index[lines.back().key]=lines.size()-1;
 	}
 }
 
+std::string& pair_file_parser::add(std::string_view _key, std::string_view _value) {
+
+	lines.push_back({{}, std::string{_key}, std::string{_value}, true, true});
+	index[lines.back().key]=lines.size()-1;
+	return lines.back().value;
+}
+
+void pair_file_parser::rebuild_index() {
+
+	index.clear();
+	for(size_t i=0; i<lines.size(); i++) {
+
+		if(lines[i].pair) {
+			index[lines[i].key]=i;
+		}
+	}
+}
+
+bool pair_file_parser::line::unchanged() const {
+
+	if(!pair) {
+		return true;
+	}
+
+	//The raw text is the key, the delimiter and the original value.
+	return !added && value==std::string_view{raw}.substr(key.size()+1);
+}
@@ -0,0 +1,86 @@
+#include <tools/parallel_line_processor.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+using namespace tools;
+
+parallel_line_processor::parallel_line_processor(
+	const std::string& _path,
+	char _comment,
+	int _flags,
+	size_t _threads,
+	size_t _chunk_size
+)
+:
+	comment{_comment},
+	line_flags{_flags},
+	own_pool{_threads ? std::make_unique<worker_pool>(_threads) : nullptr},
+	pool{_threads ? own_pool.get() : &worker_pool::shared()} {
+
+	if(!file.open(_path)) {
+		throw std::runtime_error("parallel_line_processor could not open "+_path);
+	}
+
+	split(_chunk_size);
+}
+
+parallel_line_processor::parallel_line_processor(
+	const std::string& _path,
+	worker_pool& _pool,
+	char _comment,
+	int _flags,
+	size_t _chunk_size
+)
+:
+	comment{_comment},
+	line_flags{_flags},
+	pool{&_pool} {
+
+	if(!file.open(_path)) {
+		throw std::runtime_error("parallel_line_processor could not open "+_path);
+	}
+
+	split(_chunk_size);
+}
+
+void parallel_line_processor::split(size_t _chunk_size) {
+
+	const auto data=file.data();
+	const size_t chunk_size=std::max<size_t>(1, _chunk_size);
+
+	//Chunks are extended up to the next newline so no line is ever split.
+	size_t begin=0;
+	while(begin < data.size()) {
+
+		size_t end=std::min(begin+chunk_size, data.size());
+		if(end < data.size()) {
+
+			const char * newline=static_cast<const char *>(
+				std::memchr(data.data()+end-1, '\n', data.size()-end+1)
+			);
+
+			end=nullptr==newline
+				? data.size()
+				: newline-data.data()+1;
+		}
+
+		chunks.push_back({data.substr(begin, end-begin), 0});
+		begin=end;
+	}
+
+	//Line numbers need the newline count of every previous chunk, counted
+	//as the first batch of the pool.
+	std::vector<unsigned int> newlines(chunks.size(), 0);
+	pool->run(chunks.size(), [this, &newlines](size_t _chunk) {
+		const auto& slice=chunks[_chunk].data;
+		newlines[_chunk]=std::count(std::begin(slice), std::end(slice), '\n');
+	});
+
+	unsigned int first_line=0;
+	for(size_t i=0; i<chunks.size(); i++) {
+		chunks[i].first_line=first_line;
+		first_line+=newlines[i];
+	}
+}
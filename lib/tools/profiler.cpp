@@ -0,0 +1,267 @@
+#include <tools/profiler.h>
+
+#include <rapidjson/writer.h>
+#include <rapidjson/stringbuffer.h>
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+
+using namespace tools;
+
+profiler& profiler::get() {
+
+	static profiler instance;
+	return instance;
+}
+
+profiler::ring_owner::~ring_owner() {
+
+	if(nullptr!=owned) {
+		profiler::get().release(*owned);
+	}
+}
+
+profiler::ring& profiler::local_ring() {
+
+	thread_local ring_owner owner;
+	if(nullptr==owner.owned) {
+
+		std::unique_ptr<ring> taken;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if(!spare.empty()) {
+				taken=std::move(spare.back());
+				spare.pop_back();
+			}
+		}
+
+		//Rings are large, they are not built with the lock held.
+		if(nullptr==taken) {
+			taken=std::make_unique<ring>();
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		taken->thread=threads++;
+		owner.owned=taken.get();
+		rings.push_back(std::move(taken));
+	}
+
+	return *owner.owned;
+}
+
+void profiler::release(ring& _ring) {
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	//Called by the thread of the ring, so nothing is written meanwhile.
+	const auto head=_ring.head.load(std::memory_order_relaxed);
+	copy(_ring, std::max(_ring.tail.load(std::memory_order_relaxed), head > ring_capacity ? head-ring_capacity : 0), head, exited);
+
+	_ring.started.store(0, std::memory_order_relaxed);
+	_ring.head.store(0, std::memory_order_relaxed);
+	_ring.tail.store(0, std::memory_order_relaxed);
+	_ring.depth=0;
+
+	const auto it=std::find_if(std::begin(rings), std::end(rings), [&_ring](const std::unique_ptr<ring>& _r) {
+		return _r.get()==&_ring;
+	});
+
+	spare.push_back(std::move(*it));
+	rings.erase(it);
+}
+
+void profiler::copy(
+	const ring& _ring,
+	std::uint64_t _first,
+	std::uint64_t _last,
+	std::vector<profiler_event>& _out
+) {
+
+	for(auto i=_first; i<_last; i++) {
+
+		const auto& s=_ring.events[i % ring_capacity];
+		_out.push_back({
+			s.name.load(std::memory_order_relaxed),
+			s.begin.load(std::memory_order_relaxed),
+			s.end.load(std::memory_order_relaxed),
+			s.depth.load(std::memory_order_relaxed),
+			_ring.thread
+		});
+	}
+}
+
+std::uint32_t profiler::enter() {
+
+	return local_ring().depth++;
+}
+
+void profiler::leave(
+	const char * _name,
+	std::uint64_t _begin,
+	std::uint32_t _depth
+) {
+
+	const auto end=now();
+	auto& r=local_ring();
+
+	//Only this thread writes the counters, so relaxed reads are enough. The
+	//slot is announced before it is overwritten, so a collector that read
+	//any of the new values sees it in started.
+	const auto head=r.head.load(std::memory_order_relaxed);
+	r.started.store(head+1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	auto& s=r.events[head % ring_capacity];
+	s.name.store(_name, std::memory_order_relaxed);
+	s.begin.store(_begin, std::memory_order_relaxed);
+	s.end.store(end, std::memory_order_relaxed);
+	s.depth.store(_depth, std::memory_order_relaxed);
+
+	r.head.store(head+1, std::memory_order_release);
+	r.depth=_depth;
+}
+
+std::vector<profiler_event> profiler::events() const {
+
+	std::lock_guard<std::mutex> lock(mutex);
+	std::vector<profiler_event> result=exited;
+
+	for(const auto& r : rings) {
+
+		const auto head=r->head.load(std::memory_order_acquire);
+		const auto first=std::max(r->tail.load(std::memory_order_relaxed), head > ring_capacity ? head-ring_capacity : 0);
+		const auto copied_from=result.size();
+
+		copy(*r, first, head, result);
+
+		//Anything the thread started overwriting while copying is not
+		//trustworthy.
+		std::atomic_thread_fence(std::memory_order_acquire);
+		const auto later=r->started.load(std::memory_order_relaxed);
+		if(later > first+ring_capacity) {
+
+			const auto lost=std::min<std::uint64_t>(later-ring_capacity-first, head-first);
+			result.erase(
+				std::begin(result)+copied_from,
+				std::begin(result)+copied_from+lost
+			);
+		}
+	}
+
+	std::sort(std::begin(result), std::end(result), [](const profiler_event& _a, const profiler_event& _b) {
+		return _a.begin < _b.begin;
+	});
+
+	return result;
+}
+
+std::vector<profiler_zone_stats> profiler::stats() const {
+
+	std::map<std::string, std::vector<std::uint64_t>> durations;
+	for(const auto& e : events()) {
+		durations[e.name].push_back(e.end-e.begin);
+	}
+
+	std::vector<profiler_zone_stats> result;
+	result.reserve(durations.size());
+
+	for(auto& pair : durations) {
+
+		auto& values=pair.second;
+		std::sort(std::begin(values), std::end(values));
+
+		//Nearest rank percentiles.
+		auto percentile=[&values](std::size_t _p) {
+			const std::size_t rank=(_p*values.size()+99)/100;
+			return values[std::max<std::size_t>(rank, 1)-1];
+		};
+
+		std::uint64_t total=0;
+		for(const auto v : values) {
+			total+=v;
+		}
+
+		result.push_back({
+			pair.first,
+			values.size(),
+			total,
+			values.front(),
+			values.back(),
+			percentile(50),
+			percentile(95),
+			percentile(99)
+		});
+	}
+
+	return result;
+}
+
+std::string profiler::chrome_trace() const {
+
+	const auto recorded=events();
+	const std::uint64_t origin=recorded.empty() ? 0 : recorded.front().begin;
+
+	rapidjson::StringBuffer buffer;
+	rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+
+	writer.StartObject();
+	writer.Key("displayTimeUnit");
+	writer.String("ns");
+	writer.Key("traceEvents");
+	writer.StartArray();
+
+	//Complete events, with times in microseconds.
+	for(const auto& e : recorded) {
+
+		writer.StartObject();
+		writer.Key("name");
+		writer.String(e.name);
+		writer.Key("cat");
+		writer.String("zone");
+		writer.Key("ph");
+		writer.String("X");
+		writer.Key("ts");
+		writer.Double(static_cast<double>(e.begin-origin)/1000.);
+		writer.Key("dur");
+		writer.Double(static_cast<double>(e.end-e.begin)/1000.);
+		writer.Key("pid");
+		writer.Uint(1);
+		writer.Key("tid");
+		writer.Uint(e.thread);
+		writer.Key("args");
+		writer.StartObject();
+		writer.Key("depth");
+		writer.Uint(e.depth);
+		writer.EndObject();
+		writer.EndObject();
+	}
+
+	writer.EndArray();
+	writer.EndObject();
+
+	return std::string{buffer.GetString(), buffer.GetSize()};
+}
+
+void profiler::save_chrome_trace(const std::string& _path) const {
+
+	const auto json=chrome_trace();
+
+	std::ofstream file(_path.c_str());
+	file.write(json.data(), json.size());
+
+	if(!file) {
+		throw std::runtime_error("tools::profiler::save_chrome_trace could not write "+_path);
+	}
+}
+
+void profiler::clear() {
+
+	std::lock_guard<std::mutex> lock(mutex);
+	for(auto& r : rings) {
+		r->tail.store(r->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+	}
+
+	exited.clear();
+}
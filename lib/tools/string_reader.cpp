@@ -9,9 +9,7 @@ using namespace tools;
 
 string_reader::string_reader()
 :
-	line_number{0},
-	comment{'#'},
-	flags{none} {
+	reader{'#', none} {
 
 }
 
@@ -20,71 +18,27 @@ string_reader::string_reader(
 	const char c,
 	int _flags)
 :
-	line_number(0),
-	comment(c),
-	flags{_flags} {
+	reader{c, _flags} {
 
 	set(_str);
 }
 
-//TODO: We could actually have some underlying implementation with
-//this to be shared with text_reader too, since it's basically the same
-//code.
-
 std::string string_reader::read_line() {
 
-	if(stream.eof()) {
-
-		return std::string{};
-	}
-
-	while(true){
-
-		++line_number;
-		std::string current_line;
-		std::getline(stream, current_line);
-
-		if(stream.eof()) {
-
-			return std::string();
-		}
-
-		if(flags & string_reader::ltrim ) {
-
-			tools::ltrim(current_line);
-		}
-
-		if(flags & string_reader::rtrim) {
-
-			tools::rtrim(current_line);
-		}
-
-		if(!current_line.size()) {
-
-			continue;
-		}
-
-		if(is_comment(current_line)) {
-			continue;
-		}
-
-		return current_line;
-	}
+	std::string_view line;
+	return read_line(line)
+		? std::string{line}
+		: std::string{};
 }
 
-bool string_reader::is_comment(const std::string& _line) {
-
-	if(flags & ignorewscomment && !(flags & ltrim)) {
-
-		return str_ltrim(_line)[0]==comment;
-	}
+bool string_reader::read_line(std::string_view& _line) {
 
-	return _line[0]==comment;
+	return reader.next(_line);
 }
 
 bool string_reader::set(const std::string& _str) {
 
-	line_number=0;
-	stream.str(_str);
-	return (bool)stream;
+	reader.get_source().set(_str);
+	reader.rewind();
+	return true;
 }
@@ -1,5 +1,6 @@
 #include <tools/string_utils.h>
 
+#include <tools/instrumentation.h>
 #include <tools/text_reader.h>
 #include <tools/compatibility_patches.h>
 
@@ -8,90 +9,232 @@
 #include <sstream>
 #include <iterator>
 #include <algorithm>
+#include <array>
+#include <cstring>
 
 using namespace tools;
 
 std::string	tools::implode(const std::vector<std::string>& _v, const char _s) {
 
-	std::string separator;
-	separator.append(1, _s);
-	return implode(_v, separator);
+	std::string result;
+	return implode(result, _v, _s);
 }
 
 std::string	tools::implode(const std::vector<std::string>& _v, const std::string& _s) {
 
-	std::ostringstream ss;
-	std::copy(std::begin(_v), std::end(_v),
-		std::ostream_iterator<std::string>(ss, _s.c_str()));
-
-	auto result=ss.str();
-	result.pop_back(); //Remove last.
-	return result;
+	std::string result;
+	return implode(result, _v, _s);
 }
 
 std::vector<std::string> tools::explode(const std::string & pstring, const char pdelimiter, size_t max) {
 
-	size_t count=1;
+	TOOLS_INSTRUMENT("explode");
 
 	std::vector<std::string> result;
-	std::string::const_iterator ini=pstring.begin(), fin=pstring.end();
-	std::string temp;
-
-	while(ini < fin) {
-		if( (*ini)==pdelimiter) {
-			++count;
-			result.push_back(temp);
-			temp="";
-			if(max && count >= max) {
-				temp=std::string(ini+1, pstring.end());
-				break;
-			}
-		}
-		else {
-			temp+=*ini;
-		}
-
-		++ini;
+	for(const auto piece : split_range(pstring, pdelimiter, max)) {
+		result.emplace_back(piece);
 	}
 
-	result.push_back(temp);
 	return result;
 }
 
 std::vector<std::string> tools::explode(const std::string & pstring, const std::string& delimiter, size_t max) {
 
-	size_t count=1, pos=0, prev_pos=0;
+	TOOLS_INSTRUMENT("explode");
 
 	std::vector<std::string> result;
+	for(const auto piece : split_range(pstring, std::string_view{delimiter}, max)) {
+		result.emplace_back(piece);
+	}
+
+	return result;
+}
 
-	do {
-		pos=pstring.find(delimiter, prev_pos);
+std::vector<std::string_view> tools::split_view(std::string_view _subject, const char _delimiter, size_t _max) {
 
-		if(pos==std::string::npos) {
-			result.push_back(pstring.substr(prev_pos));
-		}
-		else {
-			result.push_back(pstring.substr(prev_pos, pos-prev_pos));
-			prev_pos=pos+delimiter.size();
+	split_range range(_subject, _delimiter, _max);
+	return std::vector<std::string_view>(std::begin(range), std::end(range));
+}
+
+std::vector<std::string_view> tools::split_view(std::string_view _subject, std::string_view _delimiter, size_t _max) {
+
+	split_range range(_subject, _delimiter, _max);
+	return std::vector<std::string_view>(std::begin(range), std::end(range));
+}
+
+split_range::split_range(std::string_view _subject, char _delimiter, size_t _max)
+	:subject(_subject),
+	delimiter_char(_delimiter),
+	delimiter_size(1),
+	//A max of 1 splits once, as explode always did.
+	max_splits(_max ? std::max<size_t>(_max, 2)-1 : std::string_view::npos) {
+
+}
+
+split_range::split_range(std::string_view _subject, std::string_view _delimiter, size_t _max)
+	:subject(_subject),
+	delimiter(_delimiter),
+	delimiter_char(_delimiter.size() ? _delimiter.front() : '\0'),
+	delimiter_size(_delimiter.size()),
+	max_splits(_max ? std::max<size_t>(_max, 2)-1 : std::string_view::npos) {
+
+}
+
+size_t split_range::find(size_t _from) const {
+
+	if(_from >= subject.size()) {
+
+		return std::string_view::npos;
+	}
+
+	if(1==delimiter_size) {
+
+		//memchr is vectorized by every sane libc, so single chars take the fast lane.
+		const char * found=static_cast<const char *>(
+			std::memchr(subject.data()+_from, delimiter_char, subject.size()-_from)
+		);
+
+		return nullptr==found
+			? std::string_view::npos
+			: found-subject.data();
+	}
+
+	if(0==delimiter_size) {
+
+		return std::string_view::npos;
+	}
+
+	return subject.find(delimiter, _from);
+}
+
+split_range::iterator::iterator(const split_range& _range)
+	:range(&_range) {
+
+	advance();
+}
+
+void split_range::iterator::advance() {
+
+	if(last) {
+
+		range=nullptr;
+		return;
+	}
+
+	const size_t pos=splits < range->max_splits
+		? range->find(next)
+		: std::string_view::npos;
+
+	if(std::string_view::npos==pos) {
+
+		current=range->subject.substr(next);
+		last=true;
+		return;
+	}
+
+	current=range->subject.substr(next, pos-next);
+	next=pos+range->delimiter_size;
+	++splits;
+}
+
+split_range::iterator& split_range::iterator::operator++() {
+
+	advance();
+	return *this;
+}
+
+split_range::iterator split_range::iterator::operator++(int) {
+
+	auto copy=*this;
+	advance();
+	return copy;
+}
+
+bool split_range::iterator::operator==(const iterator& _o) const {
+
+	if(nullptr==range || nullptr==_o.range) {
+
+		return range==_o.range;
+	}
+
+	return range==_o.range
+		&& next==_o.next
+		&& last==_o.last;
+}
+
+namespace {
+
+//!Lookup table for the ASCII whitespace set of the C locale.
+const std::array<bool, 256> whitespace_table=[]() {
+
+	std::array<bool, 256> table{};
+	for(const unsigned char c : {' ', '\t', '\n', '\v', '\f', '\r'}) {
+		table[c]=true;
+	}
+	return table;
+}();
+
+}
+
+bool tools::is_whitespace(char _c) {
+
+	return whitespace_table[static_cast<unsigned char>(_c)];
+}
+
+bool tools::is_blank(std::string_view _str) {
+
+	//Most strings asked are not blank and give up on either end.
+	if(_str.empty()) {
+		return true;
+	}
+
+	if(!is_whitespace(_str.front()) || !is_whitespace(_str.back())) {
+		return false;
+	}
+
+	for(const char c : _str) {
+		if(!is_whitespace(c)) {
+			return false;
 		}
+	}
 
-		++count;
-		if(max && count >= max) break;
+	return true;
+}
+
+std::string_view tools::ltrim_view(std::string_view _str) {
+
+	size_t begin=0;
+	while(begin < _str.size() && is_whitespace(_str[begin])) {
+		++begin;
 	}
-	while(pos!=std::string::npos);
 
-	return result;
+	return _str.substr(begin);
+}
+
+std::string_view tools::rtrim_view(std::string_view _str) {
+
+	size_t end=_str.size();
+	while(end > 0 && is_whitespace(_str[end-1])) {
+		--end;
+	}
+
+	return _str.substr(0, end);
+}
+
+std::string_view tools::trim_view(std::string_view _str) {
+
+	return ltrim_view(rtrim_view(_str));
 }
 
 std::string& tools::ltrim(std::string &s) {
 
-	s.erase(s.begin(), std::find_if(s.begin(), s.end(), std::not1(std::ptr_fun<int, int>(std::isspace))));
+	s.erase(0, s.size()-ltrim_view(s).size());
 	return s;
 }
 
 std::string& tools::rtrim(std::string &s) {
 
-	s.erase(std::find_if(s.rbegin(), s.rend(), std::not1(std::ptr_fun<int, int>(std::isspace))).base(), s.end());
+	s.resize(rtrim_view(s).size());
 	return s;
 }
 
@@ -113,20 +256,17 @@ std::string& tools::replace(std::string& psubject, const std::string& psearch, c
 
 std::string tools::str_ltrim(const std::string &sub) {
 
-	std::string s(sub);
-	return ltrim(s);
+	return std::string{ltrim_view(sub)};
 }
 
 std::string tools::str_rtrim(const std::string &sub) {
 
-	std::string s(sub);
-	return rtrim(s);
+	return std::string{rtrim_view(sub)};
 }
 
 std::string tools::str_trim(const std::string &sub) {
 
-	std::string s(sub);
-	return trim(s);
+	return std::string{trim_view(sub)};
 }
 
 std::string tools::str_replace(const std::string& psubject, const std::string& psearch, const std::string& preplace) {
@@ -135,6 +275,154 @@ std::string tools::str_replace(const std::string& psubject, const std::string& p
 	return replace(s, psearch, preplace);
 }
 
+replacer::replacer(const table& _table)
+	:classes{1} {
+
+	byte_class.fill(0);
+
+	//Only bytes present in the patterns get a column in the table.
+	for(const auto& pair : _table) {
+		for(const unsigned char c : pair.first) {
+			if(!byte_class[c]) {
+				byte_class[c]=classes++;
+			}
+		}
+	}
+
+	auto add_state=[this](size_t _depth) -> int {
+
+		transitions.insert(std::end(transitions), classes, no_pattern);
+		longest.push_back(no_pattern);
+		depth.push_back(_depth);
+		return longest.size()-1;
+	};
+
+	add_state(0);
+
+	for(const auto& pair : _table) {
+
+		if(pair.first.empty()) {
+			continue;
+		}
+
+		int state=0;
+		for(const unsigned char c : pair.first) {
+
+			const size_t cell=state*classes+byte_class[c];
+			if(no_pattern==transitions[cell]) {
+
+				const int next=add_state(depth[state]+1);
+				transitions[cell]=next;
+			}
+
+			state=transitions[cell];
+		}
+
+		if(no_pattern==longest[state]) {
+			longest[state]=patterns.size();
+			patterns.push_back(pair);
+		}
+		else {
+			patterns[longest[state]].second=pair.second;
+		}
+	}
+
+	//Breadth first: turn failure links into direct transitions so that
+	//scanning is a single table lookup per byte.
+	std::vector<int> fail(longest.size(), 0), queue;
+	queue.reserve(longest.size());
+
+	for(size_t c=0; c<classes; c++) {
+
+		int& next=transitions[c];
+		if(no_pattern==next) {
+			next=0;
+		}
+		else {
+			queue.push_back(next);
+		}
+	}
+
+	for(size_t head=0; head<queue.size(); head++) {
+
+		const int state=queue[head];
+
+		//The longest pattern ending here is our own or the one at our failure state.
+		if(no_pattern==longest[state]) {
+			longest[state]=longest[fail[state]];
+		}
+
+		for(size_t c=0; c<classes; c++) {
+
+			int& next=transitions[state*classes+c];
+			const int fallback=transitions[fail[state]*classes+c];
+
+			if(no_pattern==next) {
+				next=fallback;
+			}
+			else {
+				fail[next]=fallback;
+				queue.push_back(next);
+			}
+		}
+	}
+}
+
+std::string replacer::apply(std::string_view _subject) const {
+
+	std::string result;
+	apply(_subject, result);
+	return result;
+}
+
+void replacer::apply(std::string_view _subject, std::string& _out) const {
+
+	_out.reserve(_out.size()+_subject.size());
+
+	const size_t size=_subject.size();
+	const auto npos=std::string_view::npos;
+	size_t i=0, copied=0, match_start=npos, match_length=0;
+	int state=0, match=no_pattern;
+
+	while(true) {
+
+		//Once no pending match can start before the candidate, it is final.
+		if(npos!=match_start && (i==size || i-depth[state] > match_start)) {
+
+			_out.append(_subject.data()+copied, match_start-copied);
+			_out.append(patterns[match].second);
+
+			copied=i=match_start+match_length;
+			match_start=npos;
+			state=0;
+			continue;
+		}
+
+		if(i==size) {
+			break;
+		}
+
+		state=transitions[state*classes+byte_class[static_cast<unsigned char>(_subject[i])]];
+		++i;
+
+		const int found=longest[state];
+		if(no_pattern==found) {
+			continue;
+		}
+
+		const size_t length=patterns[found].first.size(),
+			start=i-length;
+
+		if(npos==match_start || start < match_start || (start==match_start && length > match_length)) {
+			match_start=start;
+			match_length=length;
+			match=found;
+		}
+	}
+
+	_out.append(_subject.data()+copied, size-copied);
+}
+
 unsigned short int tools::utf8_begin_bytes(const char c) {
 
 	if(is_utf8_begin_6b(c)) return 6;
@@ -4,9 +4,20 @@
 #include <iostream>
 #include <memory>
 #include <cstring>
+#include <algorithm>
 
 #ifndef WINBUILD
 #include <sys/wait.h>
+#include <spawn.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <pthread.h>
+#include <mutex>
+#include <cerrno>
+
+extern char ** environ;
 #endif
 
 using namespace tools;
@@ -16,20 +27,194 @@ exec_exception::exec_exception(const std::string& _msg)
 
 }
 
+std::future<exec_result> tools::exec_async(
+	const std::string& _command,
+	const exec_options& _options
+) {
+
+	return std::async(std::launch::async, [_command, _options]() {
+		return exec_process(_command, _options).wait();
+	});
+}
+
+std::future<void> tools::exec_async(
+	const std::string& _command,
+	const exec_options& _options,
+	std::function<void(exec_result)> _callback
+) {
+
+	return std::async(std::launch::async, [_command, _options, callback=std::move(_callback)]() {
+		callback(exec_process(_command, _options).wait());
+	});
+}
+
 #ifdef WINBUILD
 
 exec_result tools::exec(
-	const char *, 
+	const char *,
 	size_t
 ) {
 
 	return {0, "this does not work under windows"};
 }
 
+exec_process::exec_process(
+	const std::string&,
+	const exec_options&
+)
+	:has_deadline(false) {
+
+}
+
+exec_process::~exec_process() {
+
+}
+
+exec_result exec_process::wait() {
+
+	return {0, "this does not work under windows"};
+}
+
+void exec_process::kill() {
+
+}
+
+void exec_process::close_fd(int&) {
+
+}
+
+void exec_process::terminate() {
+
+}
+
+int exec_process::reap() {
+
+	return 0;
+}
+
+#else
+
+namespace {
+
+//!Translates a waitpid status into the exit code, or the signal that ended
+//!or stopped the process.
+int decode_status(int _status) {
+
+	if(WIFEXITED(_status)) {
+		return WEXITSTATUS(_status);
+	}
+	else if(WIFSIGNALED(_status)) {
+		return WTERMSIG(_status);
+	}
+	else if(WIFSTOPPED(_status)) {
+		return WSTOPSIG(_status);
+	}
+
+	return _status;
+}
+
+#ifndef __linux__
+//!Without pipe2 a pipe is created and flagged in two steps: spawning takes
+//!this lock too, so no child can inherit a pipe before it is flagged.
+std::mutex pipe_mutex;
+#endif
+
+//!Creates a pipe whose ends are not inherited by spawned processes.
+void make_pipe(int (&_fds)[2]) {
+
+#ifdef __linux__
+	if(-1==::pipe2(_fds, O_CLOEXEC)) {
+		throw exec_exception(std::string("pipe could not be created: ")+strerror(errno));
+	}
 #else
+	std::lock_guard<std::mutex> lock(pipe_mutex);
+
+	if(-1==::pipe(_fds)) {
+		throw exec_exception(std::string("pipe could not be created: ")+strerror(errno));
+	}
+
+	for(const int fd : _fds) {
+		if(-1==fcntl(fd, F_SETFD, FD_CLOEXEC)) {
+			const int error=errno;
+			::close(_fds[0]);
+			::close(_fds[1]);
+			_fds[0]=_fds[1]=-1;
+			throw exec_exception(std::string("pipe could not be flagged close-on-exec: ")+strerror(error));
+		}
+	}
+#endif
+}
+
+//!Spawns the shell for the given arguments, see make_pipe.
+int spawn_shell(pid_t& _child, const posix_spawn_file_actions_t& _actions, const char * const * _argv) {
+
+#ifndef __linux__
+	std::lock_guard<std::mutex> lock(pipe_mutex);
+#endif
+	return posix_spawn(&_child, "/bin/sh", &_actions, nullptr, const_cast<char * const *>(_argv), environ);
+}
+
+//!Returns true if the error means the call would have blocked.
+bool would_block(int _error) {
+
+#if EAGAIN!=EWOULDBLOCK
+	if(EWOULDBLOCK==_error) {
+		return true;
+	}
+#endif
+	return EAGAIN==_error;
+}
+
+void set_nonblocking(int _fd) {
+
+	const int flags=fcntl(_fd, F_GETFL);
+	if(-1==flags || -1==fcntl(_fd, F_SETFL, flags | O_NONBLOCK)) {
+		throw exec_exception(std::string("pipe could not be made non-blocking: ")+strerror(errno));
+	}
+}
+
+//!Blocks SIGPIPE in the calling thread while alive, so writing to a process
+//!that closed its input fails with EPIPE instead of ending this one. A
+//!SIGPIPE raised meanwhile is consumed on destruction.
+class sigpipe_guard {
+
+	public:
+
+	sigpipe_guard() {
+
+		sigemptyset(&set);
+		sigaddset(&set, SIGPIPE);
+
+		sigset_t pending;
+		sigpending(&pending);
+		was_pending=sigismember(&pending, SIGPIPE);
+
+		pthread_sigmask(SIG_BLOCK, &set, &previous);
+	}
+
+	~sigpipe_guard() {
+
+		sigset_t pending;
+		sigpending(&pending);
+		if(!was_pending && sigismember(&pending, SIGPIPE)) {
+			int signal=0;
+			sigwait(&set, &signal);
+		}
+
+		pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+	}
+
+	private:
+
+	sigset_t	set,
+				previous;
+	bool		was_pending;
+};
+
+}
 
 exec_result tools::exec(
-	const char * _command, 
+	const char * _command,
 	size_t _bufsize
 ) {
 
@@ -39,7 +224,7 @@ exec_result tools::exec(
 			std::string("pipe could not be opened for command ")+_command
 		);
 	}
-	
+
 	std::unique_ptr<char[]> buffer(new char[_bufsize]);
 
 	memset(buffer.get(), 0, _bufsize);
@@ -48,18 +233,286 @@ exec_result tools::exec(
 		result+=buffer.get();
 	}
 
-	int status=pclose(pipe);
-	if(WIFEXITED(status)) {
-		status=WEXITSTATUS(status);
+	return {decode_status(pclose(pipe)), result};
+}
+
+exec_process::exec_process(
+	const std::string& _command,
+	const exec_options& _options
+)
+	:input(_options.input),
+	deadline(std::chrono::steady_clock::now()+_options.timeout),
+	has_deadline(_options.timeout.count() > 0) {
+
+	int in[2]={-1, -1}, out[2]={-1, -1}, err[2]={-1, -1}, wake[2]={-1, -1};
+	auto close_all=[&]() {
+		for(int * fds : {in, out, err, wake}) {
+			close_fd(fds[0]);
+			close_fd(fds[1]);
+		}
+	};
+
+	try {
+		make_pipe(in);
+		make_pipe(out);
+		make_pipe(err);
+		make_pipe(wake);
+
+		//Only the parent ends, the child gets blocking pipes.
+		for(const int fd : {in[1], out[0], err[0], wake[0], wake[1]}) {
+			set_nonblocking(fd);
+		}
+	}
+	catch(...) {
+		close_all();
+		throw;
+	}
+
+	posix_spawn_file_actions_t actions;
+	posix_spawn_file_actions_init(&actions);
+	posix_spawn_file_actions_adddup2(&actions, in[0], STDIN_FILENO);
+	posix_spawn_file_actions_adddup2(&actions, out[1], STDOUT_FILENO);
+	posix_spawn_file_actions_adddup2(&actions, err[1], STDERR_FILENO);
+
+	const char * argv[]={"sh", "-c", _command.c_str(), nullptr};
+	pid_t child=-1;
+	const int res=spawn_shell(child, actions, argv);
+	posix_spawn_file_actions_destroy(&actions);
+
+	//The child ends belong to the child now.
+	close_fd(in[0]);
+	close_fd(out[1]);
+	close_fd(err[1]);
+
+	if(0!=res) {
+		close_all();
+		throw exec_exception(
+			std::string("process could not be spawned for command ")+_command+": "+strerror(res)
+		);
+	}
+
+	pid=child;
+	in_fd=in[1];
+	out_fd=out[0];
+	err_fd=err[0];
+	wake_read=wake[0];
+	wake_write=wake[1];
+
+	if(input.empty()) {
+		close_fd(in_fd);
+	}
+}
+
+exec_process::~exec_process() {
+
+	if(-1!=pid && !reaped) {
+		terminate();
+		reap();
 	}
-	else if(WIFSIGNALED(status)) {
-		status=WTERMSIG(status);
+
+	for(int * fd : {&in_fd, &out_fd, &err_fd, &wake_read, &wake_write}) {
+		close_fd(*fd);
+	}
+}
+
+exec_result exec_process::wait() {
+
+	if(waited) {
+		throw exec_exception("exec_process::wait can only be called once");
 	}
-	else if(WIFSTOPPED(status)) {
-		status=WSTOPSIG(status);
+
+	waited=true;
+
+	sigpipe_guard guard;
+	exec_result result{0, {}};
+	size_t written=0;
+	char buffer[65536];
+
+	//Reads everything available, closing the pipe on end of file or error.
+	auto drain=[&buffer](int& _fd, std::string& _out) {
+
+		while(true) {
+
+			const auto count=::read(_fd, buffer, sizeof(buffer));
+			if(count > 0) {
+				_out.append(buffer, count);
+				continue;
+			}
+
+			if(-1==count && EINTR==errno) {
+				continue;
+			}
+
+			if(0==count || !would_block(errno)) {
+				close_fd(_fd);
+			}
+
+			return;
+		}
+	};
+
+	auto must_stop=[this, &result]() {
+
+		if(!kill_requested && !(has_deadline && std::chrono::steady_clock::now() >= deadline)) {
+			return false;
+		}
+
+		result.killed=true;
+		result.timed_out=!kill_requested;
+		terminate();
+		return true;
+	};
+
+	//Milliseconds poll may wait, which is forever without a deadline.
+	auto poll_timeout=[this](int _max) {
+
+		if(!has_deadline) {
+			return _max;
+		}
+
+		const auto left=std::chrono::ceil<std::chrono::milliseconds>(deadline-std::chrono::steady_clock::now()).count();
+		const int ms=left > 0 ? static_cast<int>(std::min<long long>(left, 1 << 30)) : 0;
+		return -1==_max ? ms : std::min(ms, _max);
+	};
+
+	while((-1!=out_fd || -1!=err_fd) && !must_stop()) {
+
+		pollfd fds[4];
+		int * owners[4];
+		nfds_t count=0;
+
+		auto add=[&](int& _fd, short _events) {
+			if(-1!=_fd) {
+				fds[count]={_fd, _events, 0};
+				owners[count++]=&_fd;
+			}
+		};
+
+		add(out_fd, POLLIN);
+		add(err_fd, POLLIN);
+		add(in_fd, POLLOUT);
+		add(wake_read, POLLIN);
+
+		if(-1==::poll(fds, count, poll_timeout(-1))) {
+
+			if(EINTR==errno) {
+				continue;
+			}
+
+			const std::string msg=strerror(errno);
+			terminate();
+			reap();
+			throw exec_exception("exec_process could not poll its pipes: "+msg);
+		}
+
+		for(nfds_t i=0; i<count; i++) {
+
+			if(!fds[i].revents) {
+				continue;
+			}
+
+			int& fd=*owners[i];
+			if(&fd==&out_fd) {
+				drain(out_fd, result.output);
+			}
+			else if(&fd==&err_fd) {
+				drain(err_fd, result.error);
+			}
+			else if(&fd==&wake_read) {
+				std::string discard;
+				drain(wake_read, discard);
+			}
+			else {
+
+				const auto count_written=::write(in_fd, input.data()+written, input.size()-written);
+				if(count_written > 0) {
+					written+=count_written;
+				}
+
+				//EPIPE means the process will not read any more.
+				if(written==input.size() || (-1==count_written && !would_block(errno) && EINTR!=errno)) {
+					close_fd(in_fd);
+					std::string{}.swap(input);
+				}
+			}
+		}
+	}
+
+	close_fd(in_fd);
+
+	//The output is closed, but the process may still be running. It is
+	//usually exiting already, so the wait starts short and backs off.
+	int status=0;
+	int backoff=0;
+	while(!result.killed) {
+
+		const auto res=waitpid(pid, &status, WNOHANG);
+		if(pid==res) {
+			reaped=true;
+			result.code=decode_status(status);
+			return result;
+		}
+
+		if(-1==res && EINTR!=errno) {
+			break;
+		}
+
+		if(must_stop()) {
+			break;
+		}
+
+		pollfd wake_fd{wake_read, POLLIN, 0};
+		if(1==::poll(&wake_fd, 1, poll_timeout(backoff))) {
+			std::string discard;
+			drain(wake_read, discard);
+		}
+
+		backoff=std::min(10, std::max(1, backoff*2));
+	}
+
+	result.code=reap();
+	return result;
+}
+
+void exec_process::kill() {
+
+	kill_requested=true;
+
+	if(-1!=wake_write) {
+		const char signal=0;
+		const auto res=::write(wake_write, &signal, 1);
+		(void)res;
+	}
+}
+
+void exec_process::close_fd(int& _fd) {
+
+	if(-1!=_fd) {
+		::close(_fd);
+		_fd=-1;
+	}
+}
+
+void exec_process::terminate() {
+
+	if(!reaped) {
+		::kill(pid, SIGKILL);
+	}
+
+	close_fd(in_fd);
+	close_fd(out_fd);
+	close_fd(err_fd);
+}
+
+int exec_process::reap() {
+
+	int status=0;
+	while(-1==waitpid(pid, &status, 0) && EINTR==errno) {
+
 	}
 
-	return {status, result};
+	reaped=true;
+	return decode_status(status);
 }
 
 #endif
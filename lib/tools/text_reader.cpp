@@ -9,9 +9,7 @@ using namespace tools;
 
 text_reader::text_reader()
 :
-	line_number{0},
-	comment{'#'},
-	flags{none} {
+	reader{'#', none} {
 
 }
 
@@ -20,90 +18,61 @@ text_reader::text_reader(
 	const char c,
 	int _flags)
 :
-	line_number(0),
-	comment(c),
-	flags{_flags} {
+	reader{c, _flags} {
 
 	open_file(path);
 }
 
 std::string text_reader::read_line() {
 
-	if(file.eof()) {
-
-		return std::string{};
-	}
-
-	while(true){
-
-		++line_number;
-		std::string current_line;
-		std::getline(file, current_line);
-
-		if(file.eof()) {
-
-			return std::string();
-		}
-
-		if(flags & text_reader::ltrim ) {
-
-			tools::ltrim(current_line);
-		}
-
-		if(flags & text_reader::rtrim) {
-
-			tools::rtrim(current_line);
-		}
-
-		if(!current_line.size()) {
-
-			continue;
-		}
-
-		if(is_comment(current_line)) {
-			continue;
-		}
-
-		return current_line;
-	}
+	std::string_view line;
+	return read_line(line)
+		? std::string{line}
+		: std::string{};
 }
 
-bool text_reader::is_comment(const std::string& _line) {
+bool text_reader::read_line(std::string_view& _line) {
 
-	if(flags & ignorewscomment && !(flags & ltrim)) {
+	return reader.next(_line);
+}
 
-		return str_ltrim(_line)[0]==comment;
-	}
+bool text_reader::open_file(const std::string& path) {
 
-	return _line[0]==comment;
+	const bool result=reader.get_source().open(path);
+	reader.rewind();
+	return result;
 }
 
-bool text_reader::open_file(const std::string& path) {
+std::vector<std::string> tools::explode_lines_from_file(const std::string& path) {
 
-	if(file) {
-		file.close();
+	text_reader L(path, '#');
+	std::vector<std::string> result;
+
+	if(!L) 	{
+		throw std::runtime_error("Unable to explode lines from "+path);
 	}
 
-	line_number=0;
-	file.open(path.c_str());
+	L.for_each_line([&result](std::string_view _line) {
+		result.emplace_back(_line);
+	});
 
-	return (bool)file;
+	return result;
 }
 
-std::vector<std::string> tools::explode_lines_from_file(const std::string& path) {
+line_buffer tools::explode_lines_to_buffer(const std::string& path) {
 
 	text_reader L(path, '#');
-	std::vector<std::string> result;
+	line_buffer result;
 
 	if(!L) 	{
 		throw std::runtime_error("Unable to explode lines from "+path);
 	}
 
-	while(true) {
-		std::string linea=L.read_line();
-		if(!L) break;
-		result.push_back(linea);
-	}
+	result.offsets.push_back(0);
+	L.for_each_line([&result](std::string_view _line) {
+		result.buffer.append(_line);
+		result.offsets.push_back(result.buffer.size());
+	});
 
 	return result;
 }
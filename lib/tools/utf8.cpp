@@ -0,0 +1,323 @@
+#include <tools/utf8.h>
+
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TOOLS_UTF8_SSE2 1
+#endif
+
+using namespace tools;
+
+namespace {
+
+const std::uint64_t high_bits=0x8080808080808080ull;
+
+bool is_continuation(unsigned char _c) {
+
+	return 0x80==(_c & 0xC0);
+}
+
+//!Returns the amount of leading ASCII bytes in the buffer, checking 16 (or
+//!8 without SSE2) bytes at a time.
+size_t ascii_prefix(const unsigned char * _p, size_t _size) {
+
+	size_t i=0;
+
+#ifdef TOOLS_UTF8_SSE2
+	for(; i+16 <= _size; i+=16) {
+
+		const __m128i chunk=_mm_loadu_si128(reinterpret_cast<const __m128i *>(_p+i));
+		if(_mm_movemask_epi8(chunk)) {
+			break;
+		}
+	}
+#endif
+
+	for(; i+8 <= _size; i+=8) {
+
+		std::uint64_t word;
+		std::memcpy(&word, _p+i, sizeof(word));
+		if(word & high_bits) {
+			break;
+		}
+	}
+
+	while(i < _size && _p[i] < 0x80) {
+		++i;
+	}
+
+	return i;
+}
+
+//!Decodes a single sequence following table 3-7 of the Unicode standard.
+//!Returns its length or 0 if the sequence is invalid.
+size_t decode_sequence(const unsigned char * _p, size_t _size, char32_t& _cp) {
+
+	const unsigned char lead=_p[0];
+
+	if(lead < 0x80) {
+		_cp=lead;
+		return 1;
+	}
+
+	size_t length=0;
+	unsigned char low=0x80, high=0xBF;
+
+	if(lead < 0xC2) {
+		return 0;
+	}
+	else if(lead < 0xE0) {
+		length=2;
+		_cp=lead & 0x1F;
+	}
+	else if(lead < 0xF0) {
+		length=3;
+		_cp=lead & 0x0F;
+		if(0xE0==lead) low=0xA0;		//Overlong.
+		else if(0xED==lead) high=0x9F;	//Surrogates.
+	}
+	else if(lead < 0xF5) {
+		length=4;
+		_cp=lead & 0x07;
+		if(0xF0==lead) low=0x90;		//Overlong.
+		else if(0xF4==lead) high=0x8F;	//Above U+10FFFF.
+	}
+	else {
+		return 0;
+	}
+
+	if(_size < length) {
+		return 0;
+	}
+
+	if(_p[1] < low || _p[1] > high) {
+		return 0;
+	}
+
+	for(size_t i=1; i<length; i++) {
+
+		if(!is_continuation(_p[i])) {
+			return 0;
+		}
+
+		_cp=(_cp << 6) | (_p[i] & 0x3F);
+	}
+
+	return length;
+}
+
+//!Returns true for code points that must stay attached to the preceding one.
+bool is_extender(char32_t _cp) {
+
+	return (_cp >= 0x0300 && _cp <= 0x036F)		//Combining diacritical marks.
+		|| (_cp >= 0x1AB0 && _cp <= 0x1AFF)
+		|| (_cp >= 0x1DC0 && _cp <= 0x1DFF)
+		|| (_cp >= 0x20D0 && _cp <= 0x20FF)
+		|| (_cp >= 0xFE20 && _cp <= 0xFE2F)
+		|| 0x200C==_cp || 0x200D==_cp				//Zero width non joiner and joiner.
+		|| (_cp >= 0xFE00 && _cp <= 0xFE0F)		//Variation selectors.
+		|| (_cp >= 0xE0100 && _cp <= 0xE01EF)
+		|| (_cp >= 0x1F3FB && _cp <= 0x1F3FF)	//Emoji modifiers.
+		|| (_cp >= 0xE0020 && _cp <= 0xE007F);	//Tags.
+}
+
+char32_t code_point_at(std::string_view _str, size_t _pos) {
+
+	char32_t cp=0;
+	return decode_sequence(reinterpret_cast<const unsigned char *>(_str.data())+_pos, _str.size()-_pos, cp)
+		? cp
+		: 0xFFFD;
+}
+
+size_t previous_boundary(std::string_view _str, size_t _pos) {
+
+	do {
+		--_pos;
+	} while(_pos > 0 && is_continuation(_str[_pos]));
+
+	return _pos;
+}
+
+//!Moves the cut point back until it no longer separates a cluster.
+std::string_view cut_at(std::string_view _str, size_t _cut) {
+
+	while(_cut > 0 && _cut < _str.size()) {
+
+		if(!is_extender(code_point_at(_str, _cut))
+			&& 0x200D!=code_point_at(_str, previous_boundary(_str, _cut))) {
+			break;
+		}
+
+		_cut=previous_boundary(_str, _cut);
+	}
+
+	return _str.substr(0, _cut);
+}
+
+}
+
+utf8_exception::utf8_exception(size_t _offset)
+	:std::runtime_error("invalid utf8 sequence at byte "+std::to_string(_offset)),
+	offset(_offset) {
+
+}
+
+size_t tools::utf8_find_invalid(std::string_view _str) {
+
+	const auto * p=reinterpret_cast<const unsigned char *>(_str.data());
+	const size_t size=_str.size();
+	size_t i=0;
+	char32_t cp=0;
+
+	while(i < size) {
+
+		i+=ascii_prefix(p+i, size-i);
+		if(i==size) {
+			break;
+		}
+
+		const size_t length=decode_sequence(p+i, size-i, cp);
+		if(!length) {
+			return i;
+		}
+
+		i+=length;
+	}
+
+	return std::string_view::npos;
+}
+
+bool tools::utf8_validate(std::string_view _str) {
+
+	return std::string_view::npos==utf8_find_invalid(_str);
+}
+
+size_t tools::utf8_length(std::string_view _str) {
+
+	const auto * p=reinterpret_cast<const unsigned char *>(_str.data());
+	const size_t size=_str.size();
+	size_t i=0, count=0;
+
+#ifdef TOOLS_UTF8_SSE2
+	//Continuation bytes are 0x80-0xBF, which are -128 to -65 as signed chars.
+	const __m128i threshold=_mm_set1_epi8(-65);
+	while(size-i >= 16) {
+
+		//Per lane counters would overflow after 255 blocks.
+		size_t blocks=(size-i) / 16;
+		if(blocks > 255) {
+			blocks=255;
+		}
+
+		__m128i counters=_mm_setzero_si128();
+		for(size_t b=0; b<blocks; b++, i+=16) {
+
+			const __m128i chunk=_mm_loadu_si128(reinterpret_cast<const __m128i *>(p+i));
+			counters=_mm_sub_epi8(counters, _mm_cmpgt_epi8(chunk, threshold));
+		}
+
+		const __m128i sums=_mm_sad_epu8(counters, _mm_setzero_si128());
+		count+=_mm_cvtsi128_si32(sums)+_mm_extract_epi16(sums, 4);
+	}
+#endif
+
+	for(; i+8 <= size; i+=8) {
+
+		std::uint64_t word;
+		std::memcpy(&word, p+i, sizeof(word));
+
+		//Marks bytes with the top bits set to 10, then adds the marks up.
+		const std::uint64_t continuations=(word & ~(word << 1)) & high_bits;
+		count+=8-(((continuations >> 7) * 0x0101010101010101ull) >> 56);
+	}
+
+	for(; i<size; i++) {
+		count+=!is_continuation(p[i]);
+	}
+
+	return count;
+}
+
+char32_t tools::utf8_decode(std::string_view _str, size_t& _pos) {
+
+	if(_pos >= _str.size()) {
+		throw utf8_exception(_pos);
+	}
+
+	char32_t cp=0;
+	const size_t length=decode_sequence(reinterpret_cast<const unsigned char *>(_str.data())+_pos, _str.size()-_pos, cp);
+	if(!length) {
+		throw utf8_exception(_pos);
+	}
+
+	_pos+=length;
+	return cp;
+}
+
+std::u32string tools::utf8_to_utf32(std::string_view _str) {
+
+	const auto * p=reinterpret_cast<const unsigned char *>(_str.data());
+	const size_t size=_str.size();
+	size_t i=0;
+	char32_t cp=0;
+
+	std::u32string result;
+	result.reserve(utf8_length(_str));
+
+	while(i < size) {
+
+		//Appending the bytes as a range would build a temporary string.
+		const size_t ascii=ascii_prefix(p+i, size-i);
+		const size_t at=result.size();
+		result.resize(at+ascii);
+		std::copy(p+i, p+i+ascii, &result[0]+at);
+		i+=ascii;
+
+		if(i==size) {
+			break;
+		}
+
+		const size_t length=decode_sequence(p+i, size-i, cp);
+		if(!length) {
+			throw utf8_exception(i);
+		}
+
+		result.push_back(cp);
+		i+=length;
+	}
+
+	return result;
+}
+
+std::string_view tools::utf8_truncate_bytes(std::string_view _str, size_t _bytes) {
+
+	if(_bytes >= _str.size()) {
+		return _str;
+	}
+
+	size_t cut=_bytes;
+	while(cut > 0 && is_continuation(_str[cut])) {
+		--cut;
+	}
+
+	return cut_at(_str, cut);
+}
+
+std::string_view tools::utf8_truncate(std::string_view _str, size_t _code_points) {
+
+	size_t cut=0;
+	while(cut < _str.size() && _code_points) {
+
+		++cut;
+		while(cut < _str.size() && is_continuation(_str[cut])) {
+			++cut;
+		}
+
+		--_code_points;
+	}
+
+	return cut_at(_str, cut);
+}
@@ -0,0 +1,151 @@
+#include <tools/worker_pool.h>
+
+#include <algorithm>
+
+using namespace tools;
+
+namespace {
+
+//Pool whose batch the current thread is working on, to run nested batches
+//in place instead of waiting for itself.
+thread_local const worker_pool * current_pool=nullptr;
+
+}
+
+worker_pool::worker_pool(std::size_t _threads) {
+
+	const std::size_t threads=_threads ? _threads : std::max(1u, std::thread::hardware_concurrency());
+
+	workers.reserve(threads-1);
+	for(std::size_t i=1; i<threads; i++) {
+		workers.emplace_back([this]() {worker_loop();});
+	}
+}
+
+worker_pool::~worker_pool() {
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping=true;
+	}
+
+	wake.notify_all();
+	for(auto& t : workers) {
+		t.join();
+	}
+}
+
+worker_pool& worker_pool::shared() {
+
+	static worker_pool instance;
+	return instance;
+}
+
+void worker_pool::run(std::size_t _count, const std::function<void(std::size_t)>& _task) {
+
+	run(_count, _task, []() {});
+}
+
+void worker_pool::run(
+	std::size_t _count,
+	const std::function<void(std::size_t)>& _task,
+	const std::function<void()>& _meanwhile
+) {
+
+	if(workers.empty() || _count < 2 || this==current_pool) {
+
+		for(std::size_t i=0; i<_count; i++) {
+			_task(i);
+		}
+
+		_meanwhile();
+		return;
+	}
+
+	std::lock_guard<std::mutex> run_lock(run_mutex);
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		task=&_task;
+		count=_count;
+		next=0;
+		failed=false;
+		error=nullptr;
+		busy=workers.size();
+		++batch;
+	}
+
+	wake.notify_all();
+
+	try {
+		_meanwhile();
+	}
+	catch(...) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if(!error) {
+			error=std::current_exception();
+		}
+		failed=true;
+	}
+
+	work();
+
+	std::exception_ptr thrown;
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		finished.wait(lock, [this]() {return 0==busy;});
+		task=nullptr;
+		std::swap(thrown, error);
+	}
+
+	if(thrown) {
+		std::rethrow_exception(thrown);
+	}
+}
+
+void worker_pool::worker_loop() {
+
+	std::uint64_t seen=0;
+	while(true) {
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [&]() {return stopping || batch!=seen;});
+			if(stopping) {
+				return;
+			}
+
+			seen=batch;
+		}
+
+		work();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if(0==--busy) {
+			finished.notify_one();
+		}
+	}
+}
+
+void worker_pool::work() {
+
+	const auto * previous=current_pool;
+	current_pool=this;
+
+	std::size_t index=0;
+	while(!failed.load(std::memory_order_relaxed) && (index=next.fetch_add(1)) < count) {
+
+		try {
+			(*task)(index);
+		}
+		catch(...) {
+			std::lock_guard<std::mutex> lock(mutex);
+			if(!error) {
+				error=std::current_exception();
+			}
+			failed=true;
+		}
+	}
+
+	current_pool=previous;
+}